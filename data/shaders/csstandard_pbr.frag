@@ -2,7 +2,7 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_GOOGLE_include_directive : enable
 
-#pragma import_defines (VSG_DIFFUSE_MAP, VSG_GREYSACLE_DIFFUSE_MAP, VSG_EMISSIVE_MAP, VSG_LIGHTMAP_MAP, VSG_NORMAL_MAP, VSG_METALLROUGHNESS_MAP, VSG_SPECULAR_MAP, VSGCS_OVERLAY_MAPS, VSG_TWO_SIDED_LIGHTING, VSG_WORKFLOW_SPECGLOSS, VSGCS_FLAT_SHADING, SHADOWMAP_DEBUG, VSGCS_TILE)
+#pragma import_defines (VSG_DIFFUSE_MAP, VSG_GREYSACLE_DIFFUSE_MAP, VSG_EMISSIVE_MAP, VSG_LIGHTMAP_MAP, VSG_NORMAL_MAP, VSG_METALLROUGHNESS_MAP, VSG_SPECULAR_MAP, VSGCS_OVERLAY_MAPS, VSG_TWO_SIDED_LIGHTING, VSG_WORKFLOW_SPECGLOSS, VSGCS_FLAT_SHADING, SHADOWMAP_DEBUG, VSGCS_TILE, VSGCS_OVERLAY_TABLE)
 
 #include "descriptor_defs.glsl"
 
@@ -40,6 +40,11 @@ layout(set = PRIMITIVE_DESCRIPTOR_SET, binding = 5) uniform sampler2D specularMa
 
 layout(set = WORLD_DESCRIPTOR_SET, binding = 0) uniform sampler2D blueNoise;
 
+#ifdef VSGCS_OVERLAY_TABLE
+// All overlay images; a tile's overlays are selected by tileParams.params[i].textureIndex.
+layout(set = WORLD_DESCRIPTOR_SET, binding = 1) uniform sampler2D overlayTable[overlayTableSize];
+#endif
+
 // The params block should be sized with maxOverlays, but it's provoking a bug linking the shader stages
 layout(set = TILE_DESCRIPTOR_SET, binding = 0) uniform TileParams 
 {
@@ -92,7 +97,11 @@ vec4 overlayTexture(uint overlayNum)
     coords = coords * tileParams.params[overlayNum].scale;
     coords = coords + tileParams.params[overlayNum].translation;
     coords.t = 1.0 - coords.t;
+#ifdef VSGCS_OVERLAY_TABLE
+    return texture(overlayTable[tileParams.params[overlayNum].textureIndex], coords);
+#else
     return texture(overlayTextures[overlayNum], coords);
+#endif
 }
 #endif
 
@@ -7,6 +7,8 @@
 #define PRIMITIVE_DESCRIPTOR_SET 3
 
 layout(constant_id = 0) const int maxOverlays = 4;
+// Must match pbr::overlayTableSize
+const int overlayTableSize = 1024;
 
 
 struct OverlayParamBlock
@@ -16,7 +18,7 @@ struct OverlayParamBlock
   float alpha;
   uint enabled;
   uint coordIndex;
-  // 4 bytes padding
+  uint textureIndex;            // index in overlayTable
 };
 
 #endif
@@ -5,6 +5,7 @@
  */
 #include "MapManipulator.h"
 
+#include "vsgCs/PredictedView.h"
 #include "vsgCs/Tracing.h"
 #include "vsgCs/WorldNode.h"
 
@@ -1517,9 +1518,53 @@ MapManipulator::apply(vsg::FrameEvent& frame)
 
     lookat->set(_viewMatrix);
 
+    predictTaskDestination(frame.time);
+
     _dirty = false;
 }
 
+// Attach the camera's pose at the end of the running animation, so that tiles can be loaded
+// there before the camera arrives.
+void
+MapManipulator::predictTaskDestination(vsg::time_point now)
+{
+    // Long and open-ended tasks (e.g. a held key) don't have a meaningful destination.
+    const double maxPredictedDuration = 10.0;
+    bool zoomingOrtho = _task._type == TASK_ZOOM && _camera->projectionMatrix.cast<vsg::Orthographic>();
+    if (_task._type == TASK_NONE || _task._duration_s > maxPredictedDuration || zoomingOrtho)
+    {
+        _camera->removeObject(vsgCs::PredictedView::objectName);
+        return;
+    }
+    State savedState = _state;
+    double dx = _task._delta.x * _task._duration_s;
+    double dy = _task._delta.y * _task._duration_s;
+    switch (_task._type)
+    {
+    case TASK_PAN:
+        pan(dx, dy);
+        break;
+    case TASK_ROTATE:
+        rotate(dx, dy);
+        break;
+    case TASK_ZOOM:
+        zoom(dx, dy);
+        break;
+    default:
+        break;
+    }
+    vsg::dmat4 destination =
+        vsg::translate(_state.center) *
+        _state.centerRotation *
+        vsg::rotate(_state.localRotation) *
+        vsg::translate(0.0, 0.0, _state.distance);
+    _state = savedState;
+    auto arrival = now + std::chrono::duration_cast<vsg::clock::duration>(
+        std::chrono::duration<double>(_task._duration_s));
+    _camera->setObject(vsgCs::PredictedView::objectName,
+                       vsgCs::PredictedView::create(vsg::inverse(destination), arrival));
+}
+
 bool
 MapManipulator::serviceTask(vsg::time_point now)
 {
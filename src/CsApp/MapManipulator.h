@@ -641,6 +641,9 @@ namespace vsgCs
         // movements.
         bool serviceTask(vsg::time_point);
 
+        // Attach the destination of the running task to the camera as a vsgCs::PredictedView.
+        void predictTaskDestination(vsg::time_point now);
+
         // returns the Euler Angles baked into _rotation, the local frame's rotation quaternion.
         void getEulerAngles(const vsg::dquat& quat, double* azim, double* pitch) const;
 
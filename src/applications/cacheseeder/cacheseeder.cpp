@@ -0,0 +1,426 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+// Fill the 3D Tiles cache for a region, without a window or a GPU, by running Cesium's tile
+// selection over grids of views looking straight down at the region from one or more altitudes.
+
+#include <vsg/all.h>
+
+#include "vsgCs/jsonUtils.h"
+#include "vsgCs/OpThreadTaskProcessor.h"
+#include "vsgCs/RuntimeEnvironment.h"
+#include "vsgCs/runtimeSupport.h"
+#include "vsgCs/TilesetNode.h"
+#include "vsgCs/WorldNode.h"
+
+#include <Cesium3DTilesSelection/IPrepareRendererResources.h>
+#include <Cesium3DTilesSelection/Tileset.h>
+#include <Cesium3DTilesSelection/ViewState.h>
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumGeospatial/Cartographic.h>
+#include <CesiumGeospatial/Ellipsoid.h>
+#include <CesiumRasterOverlays/RasterOverlay.h>
+#include <CesiumUtility/CreditSystem.h>
+
+#include <glm/glm.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+void usage(const char* name)
+{
+    std::cout
+        << "\nUsage: " << name << " <options> world.json\n\n"
+        << "Fetch the tiles and overlay images needed to view a region into the cache.\n\n"
+        << "where options include:\n"
+        << "--bbox west south east north\t region in degrees (required)\n"
+        << "--sse error\t\t maximum screen space error (default 16)\n"
+        << "--altitude meters\t height of the views above the ellipsoid (default 2000)\n"
+        << "--altitude-range low high n repeat the views at n altitudes from low to high meters,\n"
+        << "\t\t\t spaced geometrically, to seed the levels of detail seen from those heights\n"
+        << "--parallelism n\t\t simultaneous tile loads per tileset (default 32)\n"
+        << "--views-per-batch n\t views selected together (default 4)\n"
+        << "--viewport width height\t size of each view (default 1920 1080)\n"
+        << "--batch-timeout seconds\t give up on a batch of views after this long (default 600)\n"
+        << vsgCs::RuntimeEnvironment::csUsage()
+        << "--help\t\t\t print this message\n";
+}
+
+// Cesium loads the tile content and overlay images, but nothing is built from them.
+class HeadlessResourcePreparer : public Cesium3DTilesSelection::IPrepareRendererResources
+{
+public:
+    CesiumAsync::Future<Cesium3DTilesSelection::TileLoadResultAndRenderResources>
+    prepareInLoadThread(const CesiumAsync::AsyncSystem& asyncSystem,
+                        Cesium3DTilesSelection::TileLoadResult&& tileLoadResult,
+                        const glm::dmat4&,
+                        const std::any&) override
+    {
+        return asyncSystem.createResolvedFuture(
+            Cesium3DTilesSelection::TileLoadResultAndRenderResources{std::move(tileLoadResult),
+                                                                     nullptr});
+    }
+
+    void* prepareInMainThread(Cesium3DTilesSelection::Tile&, void*) override
+    {
+        return nullptr;
+    }
+
+    void free(Cesium3DTilesSelection::Tile&, void*, void*) noexcept override
+    {
+    }
+
+    void* prepareRasterInLoadThread(CesiumGltf::ImageAsset&, const std::any&) override
+    {
+        return nullptr;
+    }
+
+    void* prepareRasterInMainThread(CesiumRasterOverlays::RasterOverlayTile&, void*) override
+    {
+        return nullptr;
+    }
+
+    void freeRaster(const CesiumRasterOverlays::RasterOverlayTile&, void*, void*) noexcept override
+    {
+    }
+
+    void attachRasterInMainThread(const Cesium3DTilesSelection::Tile&,
+                                  int32_t,
+                                  const CesiumRasterOverlays::RasterOverlayTile&,
+                                  void*,
+                                  const glm::dvec2&,
+                                  const glm::dvec2&) override
+    {
+    }
+
+    void detachRasterInMainThread(const Cesium3DTilesSelection::Tile&,
+                                  int32_t,
+                                  const CesiumRasterOverlays::RasterOverlayTile&,
+                                  void*) noexcept override
+    {
+    }
+};
+
+// Count the requests and bytes that pass through an accessor.
+class CountingAssetAccessor : public CesiumAsync::IAssetAccessor
+{
+public:
+    explicit CountingAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> accessor)
+        : _accessor(std::move(accessor))
+    {
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+    get(const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<THeader>& headers) override
+    {
+        return count(_accessor->get(asyncSystem, url, headers));
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+    request(const CesiumAsync::AsyncSystem& asyncSystem,
+            const std::string& verb,
+            const std::string& url,
+            const std::vector<THeader>& headers,
+            const std::span<const std::byte>& contentPayload) override
+    {
+        return count(_accessor->request(asyncSystem, verb, url, headers, contentPayload));
+    }
+
+    void tick() noexcept override
+    {
+        _accessor->tick();
+    }
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> bytes{0};
+private:
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+    count(CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>&& future)
+    {
+        return std::move(future).thenImmediately(
+            [this](std::shared_ptr<CesiumAsync::IAssetRequest>&& request)
+            {
+                ++requests;
+                const auto* response = request->response();
+                if (!response || (response->statusCode() != 0
+                                  && (response->statusCode() < 200 || response->statusCode() >= 300)))
+                {
+                    ++failures;
+                }
+                else
+                {
+                    bytes += response->data().size();
+                }
+                return std::move(request);
+            });
+    }
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _accessor;
+};
+
+struct SeedOptions
+{
+    double west = 0.0;
+    double south = 0.0;
+    double east = 0.0;
+    double north = 0.0;
+    double altitude = 2000.0;
+    // With more than one step, altitudes from altitude to maxAltitude
+    double maxAltitude = 2000.0;
+    uint32_t altitudeSteps = 1;
+    double horizontalFov = 60.0;
+    glm::dvec2 viewportSize{1920.0, 1080.0};
+};
+
+// A grid of views looking straight down from altitude, spaced so that their footprints on the
+// ground overlap.
+void makeViews(const SeedOptions& options, double altitude,
+               std::vector<Cesium3DTilesSelection::ViewState>& result)
+{
+    using namespace CesiumGeospatial;
+    const Ellipsoid& ellipsoid = Ellipsoid::WGS84;
+    const double hfov = glm::radians(options.horizontalFov);
+    const double vfov = 2.0 * std::atan(std::tan(hfov / 2.0) * options.viewportSize.y
+                                        / options.viewportSize.x);
+    const double footprint = 2.0 * altitude * std::tan(vfov / 2.0);
+    const double spacing = 0.8 * footprint;
+    const double radius = ellipsoid.getMaximumRadius();
+    const double latStep = glm::degrees(spacing / radius);
+    for (double lat = options.south; lat <= options.north + latStep / 2.0; lat += latStep)
+    {
+        const double clampedLat = std::min(lat, options.north);
+        const double lonStep = glm::degrees(spacing / (radius * std::max(std::cos(glm::radians(clampedLat)),
+                                                                         0.01)));
+        for (double lon = options.west; lon <= options.east + lonStep / 2.0; lon += lonStep)
+        {
+            const double clampedLon = std::min(lon, options.east);
+            glm::dvec3 position = ellipsoid.cartographicToCartesian(
+                Cartographic::fromDegrees(clampedLon, clampedLat, altitude));
+            glm::dvec3 normal = ellipsoid.geodeticSurfaceNormal(position);
+            glm::dvec3 up = glm::normalize(glm::cross(normal, glm::cross(glm::dvec3(0.0, 0.0, 1.0),
+                                                                         normal)));
+            result.emplace_back(position, -normal, up, options.viewportSize, hfov, vfov, ellipsoid);
+        }
+    }
+}
+
+// The grids for all the altitudes, highest first, as those views load the coarse tiles that the
+// lower ones refine.
+std::vector<Cesium3DTilesSelection::ViewState> makeViews(const SeedOptions& options)
+{
+    std::vector<Cesium3DTilesSelection::ViewState> result;
+    if (options.altitudeSteps <= 1)
+    {
+        makeViews(options, options.altitude, result);
+        return result;
+    }
+    const double ratio = std::pow(options.maxAltitude / options.altitude,
+                                  1.0 / (options.altitudeSteps - 1));
+    for (uint32_t step = options.altitudeSteps; step > 0; --step)
+    {
+        makeViews(options, options.altitude * std::pow(ratio, step - 1), result);
+    }
+    return result;
+}
+
+std::vector<Cesium3DTilesSelection::Tileset*> findTilesets(const vsg::ref_ptr<vsg::Object>& object)
+{
+    std::vector<Cesium3DTilesSelection::Tileset*> result;
+    if (auto worldNode = vsgCs::ref_ptr_cast<vsgCs::WorldNode>(object))
+    {
+        for (const auto& node : worldNode->tilesetNodes())
+        {
+            if (auto tilesetNode = vsgCs::ref_ptr_cast<vsgCs::TilesetNode>(node))
+            {
+                result.push_back(tilesetNode->getTileset());
+            }
+        }
+    }
+    else if (auto tilesetNode = vsgCs::ref_ptr_cast<vsgCs::TilesetNode>(object))
+    {
+        result.push_back(tilesetNode->getTileset());
+    }
+    return result;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        vsg::CommandLine arguments(&argc, argv);
+
+        if (arguments.read({"--help", "-h", "-?"}))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        auto environment = vsgCs::RuntimeEnvironment::get();
+        environment->initializeOptions(arguments);
+        environment->initializeCs(arguments);
+        SeedOptions seedOptions;
+        bool haveBbox = arguments.read("--bbox", seedOptions.west, seedOptions.south,
+                                       seedOptions.east, seedOptions.north);
+        auto sse = arguments.value(16.0, "--sse");
+        arguments.read("--altitude", seedOptions.altitude);
+        bool haveAltitudeRange = arguments.read("--altitude-range", seedOptions.altitude,
+                                                seedOptions.maxAltitude, seedOptions.altitudeSteps);
+        auto parallelism = arguments.value<uint32_t>(32, "--parallelism");
+        auto viewsPerBatch = std::max(arguments.value<size_t>(4, "--views-per-batch"), size_t(1));
+        arguments.read("--viewport", seedOptions.viewportSize.x, seedOptions.viewportSize.y);
+        auto batchTimeout = std::chrono::seconds(arguments.value(600, "--batch-timeout"));
+        if (int log_level = 0; arguments.read("--log-level", log_level))
+        {
+            vsg::Logger::instance()->level = static_cast<vsg::Logger::Level>(log_level);
+        }
+        if (arguments.errors())
+        {
+            return arguments.writeErrorMessages(std::cerr);
+        }
+        if (!haveBbox || arguments.argc() < 2
+            || seedOptions.west > seedOptions.east || seedOptions.south > seedOptions.north
+            || seedOptions.altitude <= 0.0
+            || (haveAltitudeRange && (seedOptions.maxAltitude < seedOptions.altitude
+                                      || seedOptions.altitudeSteps == 0)))
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        // Tilesets built from the world file will use these externals.
+        auto counter = std::make_shared<CountingAssetAccessor>(environment->makeAssetAccessor());
+        using TE = Cesium3DTilesSelection::TilesetExternals;
+        environment->setTilesetExternals(
+            std::make_shared<TE>(TE{counter, std::make_shared<HeadlessResourcePreparer>(),
+                                    vsgCs::getAsyncSystem(),
+                                    std::make_shared<CesiumUtility::CreditSystem>(),
+                                    spdlog::default_logger(), nullptr}));
+
+        auto jsonSource = vsgCs::readFile(arguments[1], environment->options);
+        auto object = vsgCs::JSONObjectFactory::get()->buildFromSource(jsonSource);
+        auto tilesets = findTilesets(object);
+        if (tilesets.empty())
+        {
+            std::cerr << "No tilesets in " << arguments[1] << "\n";
+            return 1;
+        }
+        for (auto* tileset : tilesets)
+        {
+            auto& options = tileset->getOptions();
+            options.maximumScreenSpaceError = sse;
+            options.maximumSimultaneousTileLoads = parallelism;
+            options.enableFogCulling = false;
+            options.enableLodTransitionPeriod = false;
+            for (const auto& overlay : tileset->getOverlays())
+            {
+                overlay->getOptions().maximumSimultaneousTileLoads = parallelism;
+            }
+        }
+
+        auto views = makeViews(seedOptions);
+        std::cout << "Seeding " << views.size() << " views over " << tilesets.size()
+                  << " tilesets\n";
+        auto startTime = std::chrono::steady_clock::now();
+        auto& asyncSystem = vsgCs::getAsyncSystem();
+        for (size_t first = 0; first < views.size(); first += viewsPerBatch)
+        {
+            std::vector<Cesium3DTilesSelection::ViewState> batch(
+                views.begin() + static_cast<std::ptrdiff_t>(first),
+                views.begin() + static_cast<std::ptrdiff_t>(std::min(first + viewsPerBatch, views.size())));
+            auto batchStart = std::chrono::steady_clock::now();
+            for (;;)
+            {
+                asyncSystem.dispatchMainThreadTasks();
+                bool done = true;
+                for (auto* tileset : tilesets)
+                {
+                    const auto& result = tileset->updateViewGroup(tileset->getDefaultViewGroup(), batch);
+                    tileset->loadTiles();
+                    done = done && result.workerThreadTileLoadQueueLength == 0
+                        && result.mainThreadTileLoadQueueLength == 0
+                        && tileset->computeLoadProgress() >= 100.0f;
+                }
+                if (done)
+                {
+                    break;
+                }
+                if (std::chrono::steady_clock::now() - batchStart > batchTimeout)
+                {
+                    vsg::warn("Timed out loading views ", first, " to ", first + batch.size() - 1);
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+            std::cout << "views " << std::min(first + viewsPerBatch, views.size()) << "/" << views.size()
+                      << ", " << counter->requests << " requests, "
+                      << std::fixed << std::setprecision(1) << counter->bytes / 1.0e6 << " MB, "
+                      << elapsed.count() << " s\n";
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        double megabytes = counter->bytes / 1.0e6;
+        std::cout << "Done: " << counter->requests << " requests (" << counter->failures
+                  << " failed), " << std::fixed << std::setprecision(1) << megabytes << " MB in "
+                  << elapsed.count() << " s, " << counter->requests / elapsed.count()
+                  << " requests/s, " << megabytes / elapsed.count() << " MB/s\n";
+        if (auto worldNode = vsgCs::ref_ptr_cast<vsgCs::WorldNode>(object))
+        {
+            worldNode->shutdown();
+        }
+        else if (auto tilesetNode = vsgCs::ref_ptr_cast<vsgCs::TilesetNode>(object))
+        {
+            tilesetNode->shutdown();
+        }
+        asyncSystem.dispatchMainThreadTasks();
+        vsgCs::shutdown();
+    }
+    catch (const vsg::Exception& ve)
+    {
+        for (int i = 0; i < argc; ++i)
+        {
+            std::cerr << argv[i] << " ";
+        }
+        std::cerr << "\n[Exception] - " << ve.message << " result = " << ve.result << '\n';
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[Exception] - " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
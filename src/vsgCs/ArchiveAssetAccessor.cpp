@@ -0,0 +1,470 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "ArchiveAssetAccessor.h"
+#include "MappedFile.h"
+#include "OpThreadTaskProcessor.h"
+#include "TaskStatistics.h"
+#include "Tracing.h"
+
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace vsgCs
+{
+    // The central directory of a zip archive, read from the mapped file.
+    class ZipArchive
+    {
+    public:
+        struct Entry
+        {
+            uint64_t localHeaderOffset;
+            uint64_t compressedSize;
+            uint64_t uncompressedSize;
+            uint16_t method;
+        };
+
+        explicit ZipArchive(const std::string& path);
+        const Entry* find(const std::string& name) const
+        {
+            auto itr = _entries.find(name);
+            return itr == _entries.end() ? nullptr : &itr->second;
+        }
+        // The entry's data as stored in the archive
+        std::span<const std::byte> getStoredData(const Entry& entry) const;
+        std::shared_ptr<MappedFile> file;
+    private:
+        std::string _path;
+        std::unordered_map<std::string, Entry> _entries;
+    };
+}
+
+using namespace vsgCs;
+
+namespace
+{
+    constexpr uint32_t localHeaderSignature = 0x04034b50;
+    constexpr uint32_t centralHeaderSignature = 0x02014b50;
+    constexpr uint32_t endSignature = 0x06054b50;
+    constexpr uint32_t zip64EndSignature = 0x06064b50;
+    constexpr uint32_t zip64LocatorSignature = 0x07064b50;
+
+    // Little-endian reads with bounds checking
+    class ZipReader
+    {
+    public:
+        ZipReader(std::span<const std::byte> data, uint64_t pos)
+            : _data(data), _pos(pos)
+        {
+        }
+        uint64_t readLE(size_t bytes)
+        {
+            check(bytes);
+            uint64_t result = 0;
+            for (size_t i = 0; i < bytes; ++i)
+            {
+                result |= static_cast<uint64_t>(_data[_pos + i]) << (8 * i);
+            }
+            _pos += bytes;
+            return result;
+        }
+        uint16_t u16() { return static_cast<uint16_t>(readLE(2)); }
+        uint32_t u32() { return static_cast<uint32_t>(readLE(4)); }
+        uint64_t u64() { return readLE(8); }
+        std::string string(size_t size)
+        {
+            check(size);
+            const auto* ptr = reinterpret_cast<const char*>(_data.data() + _pos);
+            _pos += size;
+            return {ptr, ptr + size};
+        }
+        void skip(uint64_t bytes)
+        {
+            check(bytes);
+            _pos += bytes;
+        }
+        uint64_t pos() const
+        {
+            return _pos;
+        }
+    private:
+        void check(uint64_t bytes) const
+        {
+            if (_pos > _data.size() || bytes > _data.size() - _pos)
+            {
+                throw std::runtime_error("corrupt zip archive");
+            }
+        }
+        std::span<const std::byte> _data;
+        uint64_t _pos;
+    };
+
+    // Split a path like /data/city.3tz/tiles/0.glb into the archive and the entry name.
+    std::optional<std::pair<std::string, std::string>> splitArchivePath(const std::string& path)
+    {
+        std::string lower(path);
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c)
+                       {
+                           return static_cast<char>(std::tolower(c));
+                       });
+        for (const char* extension : {".3tz/", ".zip/"})
+        {
+            auto pos = lower.find(extension);
+            if (pos != std::string::npos)
+            {
+                pos += 4;
+                return std::make_pair(path.substr(0, pos), path.substr(pos + 1));
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<std::byte> inflateEntry(std::span<const std::byte> compressed, uint64_t uncompressedSize)
+    {
+        std::vector<std::byte> result(uncompressedSize);
+        z_stream stream{};
+        // Negative window bits: raw deflate data, no zlib header
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        {
+            throw std::runtime_error("inflateInit2 failed");
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(compressed.data()));
+        stream.next_out = reinterpret_cast<Bytef*>(result.data());
+        size_t inRemaining = compressed.size();
+        size_t outRemaining = result.size();
+        int status = Z_OK;
+        while (status == Z_OK)
+        {
+            // avail_in and avail_out are only 32 bits.
+            if (stream.avail_in == 0)
+            {
+                stream.avail_in = static_cast<uInt>(std::min<size_t>(inRemaining, UINT_MAX));
+                inRemaining -= stream.avail_in;
+            }
+            if (stream.avail_out == 0)
+            {
+                stream.avail_out = static_cast<uInt>(std::min<size_t>(outRemaining, UINT_MAX));
+                outRemaining -= stream.avail_out;
+            }
+            status = inflate(&stream, Z_NO_FLUSH);
+            if (status == Z_BUF_ERROR && (stream.avail_in != 0 || inRemaining != 0)
+                && (stream.avail_out != 0 || outRemaining != 0))
+            {
+                status = Z_OK;
+            }
+        }
+        inflateEnd(&stream);
+        if (status != Z_STREAM_END)
+        {
+            throw std::runtime_error("error inflating zip entry");
+        }
+        return result;
+    }
+
+    class ArchiveAssetResponse : public CesiumAsync::IAssetResponse
+    {
+    public:
+        // Zero copy: data points into the archive
+        ArchiveAssetResponse(std::shared_ptr<MappedFile> file, std::span<const std::byte> data)
+            : _statusCode(200), _file(std::move(file)), _data(data)
+        {
+        }
+
+        explicit ArchiveAssetResponse(std::vector<std::byte>&& storage)
+            : _statusCode(200), _storage(std::move(storage)), _data(_storage)
+        {
+        }
+
+        explicit ArchiveAssetResponse(uint16_t statusCode)
+            : _statusCode(statusCode)
+        {
+        }
+
+        uint16_t statusCode() const override
+        {
+            return _statusCode;
+        }
+
+        std::string contentType() const override
+        {
+            return {};
+        }
+
+        const CesiumAsync::HttpHeaders& headers() const override
+        {
+            return _headers;
+        }
+
+        std::span<const std::byte> data() const override
+        {
+            return _data;
+        }
+    private:
+        uint16_t _statusCode;
+        CesiumAsync::HttpHeaders _headers;
+        std::shared_ptr<MappedFile> _file;
+        std::vector<std::byte> _storage;
+        std::span<const std::byte> _data;
+    };
+
+    class ArchiveAssetRequest : public CesiumAsync::IAssetRequest
+    {
+    public:
+        ArchiveAssetRequest(std::string url, const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                            std::unique_ptr<ArchiveAssetResponse> response)
+            : _method("GET"), _url(std::move(url)), _response(std::move(response))
+        {
+            _headers.insert(headers.begin(), headers.end());
+        }
+
+        const std::string& method() const override
+        {
+            return _method;
+        }
+
+        const std::string& url() const override
+        {
+            return _url;
+        }
+
+        const CesiumAsync::HttpHeaders& headers() const override
+        {
+            return _headers;
+        }
+
+        const CesiumAsync::IAssetResponse* response() const override
+        {
+            return _response.get();
+        }
+    private:
+        std::string _method;
+        std::string _url;
+        CesiumAsync::HttpHeaders _headers;
+        std::unique_ptr<ArchiveAssetResponse> _response;
+    };
+}
+
+ZipArchive::ZipArchive(const std::string& path)
+    : file(MappedFile::open(path)), _path(path)
+{
+    auto data = file->data();
+    // The end of central directory record is followed by a comment of at most 64K.
+    if (data.size() < 22)
+    {
+        throw std::runtime_error(path + " is not a zip archive");
+    }
+    std::optional<uint64_t> endPos;
+    uint64_t searchEnd = data.size() > 22 + 0xffff ? data.size() - 22 - 0xffff : 0;
+    for (uint64_t pos = data.size() - 22; ; --pos)
+    {
+        if (ZipReader(data, pos).u32() == endSignature)
+        {
+            endPos = pos;
+            break;
+        }
+        if (pos == searchEnd)
+        {
+            break;
+        }
+    }
+    if (!endPos)
+    {
+        throw std::runtime_error(path + " is not a zip archive");
+    }
+    ZipReader end(data, *endPos + 10);
+    uint64_t numEntries = end.u16();
+    end.u32();                  // central directory size
+    uint64_t centralDirOffset = end.u32();
+    if (*endPos >= 20)
+    {
+        ZipReader locator(data, *endPos - 20);
+        if (locator.u32() == zip64LocatorSignature)
+        {
+            locator.u32();
+            ZipReader zip64End(data, locator.u64());
+            if (zip64End.u32() != zip64EndSignature)
+            {
+                throw std::runtime_error(path + ": corrupt zip64 end of central directory");
+            }
+            zip64End.skip(8 + 2 + 2 + 4 + 4 + 8);
+            numEntries = zip64End.u64();
+            zip64End.u64();
+            centralDirOffset = zip64End.u64();
+        }
+    }
+    _entries.reserve(numEntries);
+    ZipReader central(data, centralDirOffset);
+    for (uint64_t i = 0; i < numEntries; ++i)
+    {
+        if (central.u32() != centralHeaderSignature)
+        {
+            throw std::runtime_error(path + ": corrupt central directory");
+        }
+        central.skip(2 + 2 + 2);
+        Entry entry{};
+        entry.method = central.u16();
+        central.skip(2 + 2 + 4);
+        entry.compressedSize = central.u32();
+        entry.uncompressedSize = central.u32();
+        uint16_t nameLength = central.u16();
+        uint16_t extraLength = central.u16();
+        uint16_t commentLength = central.u16();
+        central.skip(2 + 2 + 4);
+        entry.localHeaderOffset = central.u32();
+        std::string name = central.string(nameLength);
+        uint64_t extraEnd = central.pos() + extraLength;
+        while (central.pos() + 4 <= extraEnd)
+        {
+            uint16_t id = central.u16();
+            uint16_t size = central.u16();
+            uint64_t fieldEnd = central.pos() + size;
+            if (id == 0x0001)
+            {
+                // ZIP64 values are present only for fields that overflowed.
+                if (entry.uncompressedSize == 0xffffffff)
+                {
+                    entry.uncompressedSize = central.u64();
+                }
+                if (entry.compressedSize == 0xffffffff)
+                {
+                    entry.compressedSize = central.u64();
+                }
+                if (entry.localHeaderOffset == 0xffffffff)
+                {
+                    entry.localHeaderOffset = central.u64();
+                }
+            }
+            central.skip(fieldEnd - central.pos());
+        }
+        central.skip(extraEnd - central.pos() + commentLength);
+        _entries.emplace(std::move(name), entry);
+    }
+}
+
+std::span<const std::byte> ZipArchive::getStoredData(const Entry& entry) const
+{
+    auto data = file->data();
+    ZipReader local(data, entry.localHeaderOffset);
+    if (local.u32() != localHeaderSignature)
+    {
+        throw std::runtime_error(_path + ": corrupt local file header");
+    }
+    local.skip(2 + 2 + 2 + 2 + 2 + 4 + 4 + 4);
+    uint16_t nameLength = local.u16();
+    uint16_t extraLength = local.u16();
+    local.skip(nameLength + extraLength);
+    uint64_t start = local.pos();
+    local.skip(entry.compressedSize);
+    return data.subspan(start, entry.compressedSize);
+}
+
+ArchiveAssetAccessor::ArchiveAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> accessor)
+    : _accessor(std::move(accessor))
+{
+}
+
+ArchiveAssetAccessor::~ArchiveAssetAccessor() = default;
+
+std::shared_ptr<ZipArchive> ArchiveAssetAccessor::getArchive(const std::string& path)
+{
+    // Held during the (fast) parse so that an archive is only opened once.
+    std::lock_guard<std::mutex> lock(_archivesMutex);
+    auto itr = _archives.find(path);
+    if (itr != _archives.end())
+    {
+        return itr->second;
+    }
+    auto archive = std::make_shared<ZipArchive>(path);
+    _archives.emplace(path, archive);
+    return archive;
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+ArchiveAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem,
+                          const std::string& url,
+                          const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+{
+    auto archivePath = splitArchivePath(getFileUrlPath(url));
+    if (!archivePath)
+    {
+        return _accessor->get(asyncSystem, url, headers);
+    }
+    return asyncSystem.runInThreadPool(
+        getIOThreadPool(),
+        instrumentTask(TaskCategory::Fetch, [this, url, headers, archivePath = std::move(*archivePath)]()
+        -> std::shared_ptr<CesiumAsync::IAssetRequest>
+        {
+            VSGCS_ZONESCOPEDN("ArchiveAssetAccessor::get");
+            auto archive = getArchive(archivePath.first);
+            const auto* entry = archive->find(archivePath.second);
+            if (!entry)
+            {
+                return std::make_shared<ArchiveAssetRequest>(
+                    url, headers, std::make_unique<ArchiveAssetResponse>(uint16_t(404)));
+            }
+            auto stored = archive->getStoredData(*entry);
+            std::unique_ptr<ArchiveAssetResponse> response;
+            if (entry->method == 0)
+            {
+                response = std::make_unique<ArchiveAssetResponse>(archive->file, stored);
+            }
+            else if (entry->method == 8)
+            {
+                response = std::make_unique<ArchiveAssetResponse>(inflateEntry(stored,
+                                                                               entry->uncompressedSize));
+            }
+            else
+            {
+                throw std::runtime_error(url + ": unsupported zip compression method "
+                                         + std::to_string(entry->method));
+            }
+            return std::make_shared<ArchiveAssetRequest>(url, headers, std::move(response));
+        }));
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+ArchiveAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem,
+                              const std::string& verb,
+                              const std::string& url,
+                              const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                              const std::span<const std::byte>& contentPayload)
+{
+    return _accessor->request(asyncSystem, verb, url, headers, contentPayload);
+}
+
+void ArchiveAssetAccessor::tick() noexcept
+{
+    _accessor->tick();
+}
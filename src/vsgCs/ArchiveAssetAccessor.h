@@ -0,0 +1,78 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <CesiumAsync/IAssetAccessor.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vsgCs
+{
+    class ZipArchive;
+
+    /**
+     * @brief An asset accessor that reads files inside 3D Tiles archives (.3tz) and zip files.
+     *
+     * A file: URL with a path like /data/city.3tz/tileset.json names the entry tileset.json in
+     * the archive /data/city.3tz; relative URLs in the tileset then resolve to other entries in
+     * the same archive. An archive is opened the first time it is used and its central directory
+     * is read into a hash table. Stored (uncompressed) entries are served straight from the mapped
+     * archive; deflated entries are inflated.
+     *
+     * All other requests are passed to the wrapped accessor.
+     */
+    class VSGCS_EXPORT ArchiveAssetAccessor : public CesiumAsync::IAssetAccessor
+    {
+    public:
+        explicit ArchiveAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> accessor);
+        ~ArchiveAssetAccessor() override;
+
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            get(const CesiumAsync::AsyncSystem& asyncSystem,
+                const std::string& url,
+                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+            override;
+
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            request(
+                const CesiumAsync::AsyncSystem& asyncSystem,
+                const std::string& verb,
+                const std::string& url,
+                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                const std::span<const std::byte>& contentPayload) override;
+
+        void tick() noexcept override;
+    private:
+        std::shared_ptr<ZipArchive> getArchive(const std::string& path);
+        std::shared_ptr<CesiumAsync::IAssetAccessor> _accessor;
+        std::mutex _archivesMutex;
+        std::unordered_map<std::string, std::shared_ptr<ZipArchive>> _archives;
+    };
+}
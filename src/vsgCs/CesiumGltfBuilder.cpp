@@ -27,6 +27,8 @@ SOFTWARE.
 #include "pbr.h"
 
 #include "LoadGltfResult.h"
+#include "OverlayTextureTable.h"
+#include "TileParameterBuffer.h"
 #include "runtimeSupport.h"
 #include "Tracing.h"
 
@@ -135,50 +137,189 @@ namespace
         }
         return rasters;
     }
-}
 
-vsg::ref_ptr<vsg::StateCommand> makeTileStateCommand(const vsg::ref_ptr<GraphicsEnvironment>& genv,
-                                                     const Rasters& rasters,
-                                                     const Cesium3DTilesSelection::Tile& tile)
-{
-    vsg::ImageInfoList rasterImages(rasters.overlayRasters.size());
-    // The topology doesn't matter because the pipeline layouts of shader versions are compatible.
-    auto descriptorBuilder
-        = vsg::DescriptorConfigurator::create(genv->shaderFactory
-                                              ->getShaderSet(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST));
-    std::vector<pbr::OverlayParams> overlayParams(rasters.overlayRasters.size());
-    for (size_t i = 0; i < rasters.overlayRasters.size(); ++i)
+    // The descriptor sets for a tile's TILE_DESCRIPTOR_SET. They all share the tile's slot in the
+    // TileParameterBuffer. When the tile's overlays change, a set that no frame in flight uses is
+    // written in place and bound, instead of building and compiling new tile state.
+    struct TileDescriptors : public vsg::Inherit<vsg::Object, TileDescriptors>
     {
-        const auto& rasterData = rasters.overlayRasters[i];
-        rasterImages[i] = rasterData.rasterImage.valid()
-            ? rasterData.rasterImage : genv->defaultTexture;
-        overlayParams[i] = rasterData.overlayParams;
+        struct Slot
+        {
+            vsg::ref_ptr<vsg::BindDescriptorSet> command;
+            vsg::ref_ptr<RewritableDescriptorSet> descriptorSet;
+            vsg::ref_ptr<vsg::DescriptorImage> overlayTextures;
+            // The frame in which the slot was bound, and the one in which it was replaced
+            uint64_t activatedFrame = 0;
+            uint64_t retiredFrame = 0;
+        };
+        std::vector<Slot> slots;
+        size_t active = 0;
+        uint32_t parameterSlot = 0;
+    };
+
+    void assignOverlayTextures(const vsg::ref_ptr<GraphicsEnvironment>& genv, const Rasters& rasters,
+                               vsg::DescriptorImage& overlayTextures)
+    {
+        overlayTextures.imageInfoList.resize(rasters.overlayRasters.size());
+        for (size_t i = 0; i < rasters.overlayRasters.size(); ++i)
+        {
+            const auto& rasterData = rasters.overlayRasters[i];
+            overlayTextures.imageInfoList[i] = rasterData.rasterImage.valid()
+                ? rasterData.rasterImage : genv->defaultTexture;
+        }
+    }
+
+    std::vector<pbr::OverlayParams> getOverlayParams(const Rasters& rasters)
+    {
+        std::vector<pbr::OverlayParams> overlayParams(rasters.overlayRasters.size());
+        for (size_t i = 0; i < rasters.overlayRasters.size(); ++i)
+        {
+            overlayParams[i] = rasters.overlayRasters[i].overlayParams;
+        }
+        return overlayParams;
     }
-    descriptorBuilder->assignTexture("overlayTextures", rasterImages);
-    auto ubo = pbr::makeTileData(tile.getGeometricError(), std::min(genv->features.pointSizeRange[1], 4.0f),
-                                 overlayParams);
-    ubo->properties.dataVariance = vsg::DYNAMIC_DATA;
-    descriptorBuilder->assignDescriptor("tileParams", ubo);
-    if (descriptorBuilder->descriptorSets.size() < pbr::TILE_DESCRIPTOR_SET + 1
-        || !descriptorBuilder->descriptorSets[pbr::TILE_DESCRIPTOR_SET])
+
+    TileDescriptors::Slot makeSlot(const vsg::ref_ptr<GraphicsEnvironment>& genv,
+                                   const vsg::ref_ptr<vsg::DescriptorSetLayout>& layout,
+                                   vsg::Descriptors descriptors,
+                                   vsg::ref_ptr<vsg::DescriptorImage> overlayTextures)
     {
-        vsg::fatal("Tile descriptor set construction failed.");
+        auto descriptorSet = RewritableDescriptorSet::create(layout, descriptors);
+        auto bindDescriptorSet
+            = BindTileDescriptorSet::create(genv->tileParameters, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                            genv->overlayPipelineLayout, pbr::TILE_DESCRIPTOR_SET,
+                                            descriptorSet);
+        return TileDescriptors::Slot{bindDescriptorSet, descriptorSet, overlayTextures};
     }
-    for (unsigned i = 0; i < descriptorBuilder->descriptorSets.size(); ++i)
+
+    vsg::ref_ptr<TileDescriptors> makeTileDescriptors(const vsg::ref_ptr<GraphicsEnvironment>& genv,
+                                                      const Rasters& rasters,
+                                                      const Cesium3DTilesSelection::Tile& tile)
     {
-        if (i != pbr::TILE_DESCRIPTOR_SET && descriptorBuilder->descriptorSets[i]
-            && !descriptorBuilder->descriptorSets[i]->descriptors.empty())
+        vsg::ImageInfoList rasterImages(rasters.overlayRasters.size());
+        // The topology doesn't matter because the pipeline layouts of shader versions are compatible.
+        auto descriptorBuilder
+            = vsg::DescriptorConfigurator::create(genv->shaderFactory
+                                                  ->getShaderSet(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST));
+        auto overlayParams = getOverlayParams(rasters);
+        for (size_t i = 0; i < rasters.overlayRasters.size(); ++i)
+        {
+            const auto& rasterData = rasters.overlayRasters[i];
+            // With the overlay texture table, the tile's own overlay textures aren't used.
+            rasterImages[i] = rasterData.rasterImage.valid() && !genv->overlayTable
+                ? rasterData.rasterImage : genv->defaultTexture;
+        }
+        descriptorBuilder->assignTexture("overlayTextures", rasterImages);
+        pbr::TileParams tileParams;
+        tileParams.geometricError = static_cast<float>(tile.getGeometricError());
+        tileParams.maxPointSize = std::min(genv->features.pointSizeRange[1], 4.0f);
+        std::copy(overlayParams.begin(), overlayParams.end(), std::begin(tileParams.overlayParams));
+        uint32_t parameterSlot = genv->tileParameters->allocate(tileParams);
+        vsg::BufferInfoList tileBuffer{genv->tileParameters->getBufferInfo(parameterSlot)};
+        descriptorBuilder->assignDescriptor("tileParams", tileBuffer);
+        if (descriptorBuilder->descriptorSets.size() < pbr::TILE_DESCRIPTOR_SET + 1
+            || !descriptorBuilder->descriptorSets[pbr::TILE_DESCRIPTOR_SET])
         {
-            vsg::warn("Unexpected descriptor set ", i, " in tile.");
+            vsg::fatal("Tile descriptor set construction failed.");
         }
+        for (unsigned i = 0; i < descriptorBuilder->descriptorSets.size(); ++i)
+        {
+            if (i != pbr::TILE_DESCRIPTOR_SET && descriptorBuilder->descriptorSets[i]
+                && !descriptorBuilder->descriptorSets[i]->descriptors.empty())
+            {
+                vsg::warn("Unexpected descriptor set ", i, " in tile.");
+            }
+        }
+        const auto& configured = descriptorBuilder->descriptorSets[pbr::TILE_DESCRIPTOR_SET];
+        vsg::ref_ptr<vsg::DescriptorImage> overlayTextures;
+        for (const auto& descriptor : configured->descriptors)
+        {
+            if (auto descriptorImage = ref_ptr_cast<vsg::DescriptorImage>(descriptor))
+            {
+                overlayTextures = descriptorImage;
+            }
+        }
+        auto result = TileDescriptors::create();
+        result->parameterSlot = parameterSlot;
+        result->slots.push_back(makeSlot(genv, configured->setLayout, configured->descriptors, overlayTextures));
+        return result;
     }
-    auto bindDescriptorSet
-            = vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                             genv->overlayPipelineLayout, pbr::TILE_DESCRIPTOR_SET,
-                                             descriptorBuilder->descriptorSets[pbr::TILE_DESCRIPTOR_SET]);
-    return bindDescriptorSet;
- }
 
+    // A new slot, with its own copy of the overlay textures descriptor
+    TileDescriptors::Slot& addSlot(const vsg::ref_ptr<GraphicsEnvironment>& genv, TileDescriptors& tileDescriptors)
+    {
+        const auto& first = tileDescriptors.slots.front();
+        auto overlayTextures = vsg::DescriptorImage::create(first.overlayTextures->imageInfoList,
+                                                            first.overlayTextures->dstBinding,
+                                                            first.overlayTextures->dstArrayElement,
+                                                            first.overlayTextures->descriptorType);
+        vsg::Descriptors descriptors = first.descriptorSet->descriptors;
+        std::replace(descriptors.begin(), descriptors.end(),
+                     vsg::ref_ptr<vsg::Descriptor>(first.overlayTextures),
+                     vsg::ref_ptr<vsg::Descriptor>(overlayTextures));
+        tileDescriptors.slots.push_back(makeSlot(genv, first.descriptorSet->setLayout, descriptors,
+                                                 overlayTextures));
+        return tileDescriptors.slots.back();
+    }
+
+    // Bind a descriptor set for the tile's current rasters.
+    ModifyRastersResult updateTileDescriptors(const vsg::ref_ptr<GraphicsEnvironment>& genv,
+                                              const vsg::ref_ptr<vsg::Node>& node,
+                                              const Rasters& rasters,
+                                              vsg::StateGroup& stateGroup,
+                                              const FrameProgress& progress)
+    {
+        ModifyRastersResult result;
+        vsg::ref_ptr<TileDescriptors> tileDescriptors(node->getObject<TileDescriptors>("vsgCs_tileDescriptors"));
+        if (!tileDescriptors)
+        {
+            vsg::warn("Tile has no descriptors.");
+            return result;
+        }
+        auto overlayParams = getOverlayParams(rasters);
+        auto tileParams = genv->tileParameters->get(tileDescriptors->parameterSlot);
+        std::copy(overlayParams.begin(), overlayParams.end(), std::begin(tileParams.overlayParams));
+        genv->tileParameters->set(tileDescriptors->parameterSlot, tileParams);
+        if (genv->overlayTable)
+        {
+            // The tile's descriptor set doesn't change; the table must hold the new raster
+            // before the tile is drawn.
+            return genv->overlayTable->update(progress);
+        }
+        auto& slots = tileDescriptors->slots;
+        size_t next = tileDescriptors->active;
+        // The active slot can be written if it was bound in this frame, which hasn't been recorded
+        // yet. Otherwise, look for one that no frame in flight uses.
+        if (slots[next].activatedFrame != progress.frameCount)
+        {
+            slots[next].retiredFrame = progress.frameCount;
+            auto itr = std::find_if(slots.begin(), slots.end(),
+                                    [&](const TileDescriptors::Slot& slot)
+                                    {
+                                        return &slot != &slots[tileDescriptors->active]
+                                            && progress.isComplete(slot.retiredFrame);
+                                    });
+            next = static_cast<size_t>(itr - slots.begin());
+        }
+        bool newSlot = next == slots.size();
+        auto& slot = newSlot ? addSlot(genv, *tileDescriptors) : slots[next];
+        assignOverlayTextures(genv, rasters, *slot.overlayTextures);
+        if (newSlot)
+        {
+            result.compileObjects.emplace_back(slot.command);
+        }
+        else
+        {
+            result.rewriteObjects.emplace_back(slot.descriptorSet);
+        }
+        slot.activatedFrame = progress.frameCount;
+        tileDescriptors->active = next;
+        // The replaced command is kept by the TileDescriptors.
+        stateGroup.stateCommands.clear();
+        stateGroup.stateCommands.push_back(slot.command);
+        return result;
+    }
+}
 
 vsg::ref_ptr<vsg::Group>
 CesiumGltfBuilder::load(CesiumGltf::Model* model, const CreateModelOptions& options)
@@ -214,31 +355,6 @@ vsg::ref_ptr<vsg::StateGroup> CesiumGltfBuilder::getTileStateGroup(const vsg::re
     return ref_ptr_cast<vsg::StateGroup>(transformNode->children[0]);
 }
 
-vsg::ref_ptr<vsg::Data> CesiumGltfBuilder::getTileData(const vsg::ref_ptr<vsg::Node>& node)
-{
-    auto tileSG = CesiumGltfBuilder::getTileStateGroup(node);
-    // How can state commands be empty? Seems like tiles can be in the updated view result and not
-    // be prepared yet ?!?
-    if (tileSG && !tileSG->stateCommands.empty())
-    {
-        // only 1 state command
-        auto bindDesc = ref_ptr_cast<vsg::BindDescriptorSet>(tileSG->stateCommands[0]);
-        auto ds = bindDesc->descriptorSet;
-        auto descBuffItr = std::find_if(ds->descriptors.begin(), ds->descriptors.end(),
-                                        [](auto && descriptor)
-                                        { return !!ref_ptr_cast<vsg::DescriptorBuffer>(descriptor); });
-        if (descBuffItr == ds->descriptors.end())
-        {
-            vsg::warn("could not find tile DescriptorBuffer");
-            return {};
-        }
-        auto descBuff = ref_ptr_cast<vsg::DescriptorBuffer>(*descBuffItr);
-        auto uboData = descBuff->bufferInfoList[0]->data;
-        return uboData;
-    }
-    return {};
-}
-
 vsg::ref_ptr<vsg::Node> CesiumGltfBuilder::loadTile(Cesium3DTilesSelection::TileLoadResult&& tileLoadResult,
                                                     const glm::dmat4 &transform,
                                                     const CreateModelOptions& modelOptions)
@@ -280,11 +396,8 @@ vsg::ref_ptr<vsg::Node> CesiumGltfBuilder::loadTile(Cesium3DTilesSelection::Tile
 
 // Due to the workings of cesium-native, the BindDescriptorSet command for a
 // tile's overlay textures and tile parameters needs to be created in the main
-// thread. The tile parameters need to be writeable (fading), and in order to
-// get at its buffer we need to maintain a consistent state in the StateGroup
-// i.e., only one command. Later we may add a direct ref_ptr to a tile's
-// writable data from the RenderResources structure, but that will still need to
-// be the same data that is bound to a buffer in the state command.
+// thread. The tile parameters are writeable (fading) through the tile's slot in
+// the TileParameterBuffer, which is kept in the RenderResources structure.
 
 AttachTileDataResult
 CesiumGltfBuilder::attachTileData(Cesium3DTilesSelection::Tile& tile,
@@ -292,7 +405,9 @@ CesiumGltfBuilder::attachTileData(Cesium3DTilesSelection::Tile& tile,
 {
     auto rasters = getOrCreateRasters(node);
     auto tileStateGroup = getTileStateGroup(node);
-    auto tileStateCommand = makeTileStateCommand(_genv, *rasters, tile);
+    auto tileDescriptors = makeTileDescriptors(_genv, *rasters, tile);
+    node->setObject("vsgCs_tileDescriptors", tileDescriptors);
+    auto tileStateCommand = tileDescriptors->slots.front().command;
     if (!tileStateGroup->stateCommands.empty())
     {
         vsg::warn("tile state group already has command.");
@@ -312,9 +427,9 @@ CesiumGltfBuilder::attachTileData(Cesium3DTilesSelection::Tile& tile,
             bounds = visit(BoundingSphereOperation(), tile.getBoundingVolume());
         }
         auto cullNode = vsg::CullNode::create(bounds, transformNode);
-        return {tileStateCommand, cullNode};
+        return {tileStateCommand, cullNode, tileDescriptors->parameterSlot};
     }
-    return {tileStateCommand, node};
+    return {tileStateCommand, node, tileDescriptors->parameterSlot};
 }
 
 vsg::ref_ptr<vsg::ImageInfo> CesiumGltfBuilder::loadTexture(CesiumGltf::ImageAsset& image,
@@ -338,15 +453,15 @@ vsg::ref_ptr<vsg::ImageInfo> CesiumGltfBuilder::loadTexture(CesiumGltf::ImageAss
 }
 
 
-ModifyRastersResult CesiumGltfBuilder::attachRaster(const Cesium3DTilesSelection::Tile& tile,
+ModifyRastersResult CesiumGltfBuilder::attachRaster(const Cesium3DTilesSelection::Tile&,
                                                     const vsg::ref_ptr<vsg::Node>& node,
                                                     int32_t overlayTextureCoordinateID,
                                                     const CesiumRasterOverlays::RasterOverlayTile&,
                                                     void* pMainThreadRendererResources,
                                                     const glm::dvec2& translation,
-                                                    const glm::dvec2& scale)
+                                                    const glm::dvec2& scale,
+                                                    const FrameProgress& progress)
 {
-    ModifyRastersResult result;
     vsg::ref_ptr<Rasters> rasters = getOrCreateRasters(node);
     vsg::ref_ptr<vsg::StateGroup> stateGroup = getTileStateGroup(node);
     if (!stateGroup)
@@ -362,28 +477,17 @@ ModifyRastersResult CesiumGltfBuilder::attachRaster(const Cesium3DTilesSelection
     rasterData.overlayParams.coordIndex = overlayTextureCoordinateID;
     rasterData.overlayParams.enabled = 1;
     rasterData.overlayParams.alpha = resource->overlayOptions.alpha;
-    auto command = makeTileStateCommand(_genv, *rasters, tile);
-    // XXX Should check data or something in the state command instead of relying on the number of
-    // commands in the group.
-    auto& stateCommands = stateGroup->stateCommands;
-    if (!stateCommands.empty())
-    {
-        result.deleteObjects.insert(result.deleteObjects.end(),
-                                    stateCommands.begin(), stateCommands.end());
-        stateCommands.clear();
-    }
-    stateCommands.push_back(command);
-    result.compileObjects.emplace_back(command);
-    return result;
+    rasterData.overlayParams.textureIndex = resource->tableIndex;
+    return updateTileDescriptors(_genv, node, *rasters, *stateGroup, progress);
 }
 
 ModifyRastersResult
-CesiumGltfBuilder::detachRaster(const Cesium3DTilesSelection::Tile& tile,
+CesiumGltfBuilder::detachRaster(const Cesium3DTilesSelection::Tile&,
                                 const vsg::ref_ptr<vsg::Node>& node,
                                 int32_t,
-                                const CesiumRasterOverlays::RasterOverlayTile& rasterTile)
+                                const CesiumRasterOverlays::RasterOverlayTile& rasterTile,
+                                const FrameProgress& progress)
 {
-    ModifyRastersResult result;
     vsg::ref_ptr<Rasters> rasters = getOrCreateRasters(node);
     vsg::ref_ptr<vsg::StateGroup> stateGroup = getTileStateGroup(node);
     if (!stateGroup)
@@ -392,21 +496,8 @@ CesiumGltfBuilder::detachRaster(const Cesium3DTilesSelection::Tile& tile,
     }
     auto *resource = static_cast<RasterResources*>(rasterTile.getRendererResources());
     auto& rasterData = rasters->overlayRasters.at(resource->overlayOptions.layerNumber);
-    {
-        rasterData.rasterImage = {}; // ref to rasterImage is still held by the old StateCommand
-        rasterData.overlayParams.enabled = 0;
-        auto newCommand = makeTileStateCommand(_genv, *rasters, tile);
-        // XXX Should check data or something in the state command instead of relying on the number of
-        // commands in the group.
-        auto& stateCommands = stateGroup->stateCommands;
-        if (!stateCommands.empty())
-        {
-            result.deleteObjects.insert(result.deleteObjects.end(),
-                                        stateCommands.begin(), stateCommands.end());
-            stateCommands.clear();
-        }
-        stateCommands.push_back(newCommand);
-        result.compileObjects.emplace_back(newCommand);
-    }
-    return result;
+    // A ref to rasterImage is still held by the descriptor sets that frames in flight may use.
+    rasterData.rasterImage = {};
+    rasterData.overlayParams.enabled = 0;
+    return updateTileDescriptors(_genv, node, *rasters, *stateGroup, progress);
 }
@@ -41,6 +41,7 @@ SOFTWARE.
 
 
 #include <array>
+#include <optional>
 
 // Build a VSG scenegraph from a Cesium Gltf Model object.
 
@@ -53,14 +54,18 @@ namespace vsgCs
     {
         std::vector<vsg::ref_ptr<vsg::Object>> compileObjects;
         std::vector<vsg::ref_ptr<vsg::Object>> deleteObjects;
+        // Compiled descriptor sets that need to be written again
+        std::vector<vsg::ref_ptr<RewritableDescriptorSet>> rewriteObjects;
     };
 
     // attachTileData(), called by prepareInMainThread(), returns both a descriptor set that has
-    // been compiled as well as possibly updated model tile (with a tile bounding volume).
+    // been compiled as well as possibly updated model tile (with a tile bounding volume), and the
+    // tile's slot in the TileParameterBuffer.
     struct AttachTileDataResult
     {
         vsg::ref_ptr<vsg::Object> descriptorData;
         vsg::ref_ptr<vsg::Node> updatedModel;
+        uint32_t parameterSlot = 0;
     };
 
     // Interface from Cesium Native to the VSG scene graph. CesiumGltfBuilder can load Models (glTF
@@ -91,13 +96,14 @@ namespace vsgCs
                                          const CesiumRasterOverlays::RasterOverlayTile& rasterTile,
                                          void* pMainThreadRendererResources,
                                          const glm::dvec2& translation,
-                                         const glm::dvec2& scale);
+                                         const glm::dvec2& scale,
+                                         const FrameProgress& progress);
         ModifyRastersResult detachRaster(const Cesium3DTilesSelection::Tile& tile,
                                          const vsg::ref_ptr<vsg::Node>& node,
                                          int32_t overlayTextureCoordinateID,
-                                         const CesiumRasterOverlays::RasterOverlayTile& rasterTile);
+                                         const CesiumRasterOverlays::RasterOverlayTile& rasterTile,
+                                         const FrameProgress& progress);
         static vsg::ref_ptr<vsg::StateGroup> getTileStateGroup(const vsg::ref_ptr<vsg::Node>& node);
-        static vsg::ref_ptr<vsg::Data> getTileData(const vsg::ref_ptr<vsg::Node>& node);
     protected:
         vsg::ref_ptr<GraphicsEnvironment> _genv;
     };
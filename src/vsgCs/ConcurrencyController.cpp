@@ -0,0 +1,141 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "ConcurrencyController.h"
+#include "Tracing.h"
+#include "UrlAssetAccessor.h"
+
+#include <algorithm>
+
+using namespace vsgCs;
+
+ConcurrencyController::ConcurrencyController(const AdaptiveConcurrencyOptions& options,
+                                             int32_t initialLimit)
+    : _options(options),
+      _limit(std::clamp(initialLimit, options.minimum, std::max(options.minimum, options.maximum)))
+{
+}
+
+std::optional<int32_t> ConcurrencyController::update(std::chrono::steady_clock::time_point now,
+                                                     const HostTelemetry& telemetry,
+                                                     uint64_t waits)
+{
+    if (_lastSample && now - *_lastSample < _options.interval)
+    {
+        return {};
+    }
+    NetworkTelemetry::Totals totals;
+    totals.requests = telemetry.total.count();
+    totals.errors = telemetry.errors.load(std::memory_order_relaxed);
+    totals.bytes = telemetry.bytes.sum();
+    totals.firstByte = telemetry.firstByte.sum();
+    totals.total = telemetry.total.sum();
+    if (!_lastSample)
+    {
+        _lastSample = now;
+        _lastTotals = totals;
+        _lastWaits = waits;
+        return {};
+    }
+    std::chrono::duration<double> elapsed = now - *_lastSample;
+    uint64_t requests = totals.requests - _lastTotals.requests;
+    uint64_t errors = totals.errors - _lastTotals.errors;
+    uint64_t bytes = totals.bytes - _lastTotals.bytes;
+    uint64_t firstByte = totals.firstByte - _lastTotals.firstByte;
+    bool waiting = waits != _lastWaits;
+    _lastSample = now;
+    _lastTotals = totals;
+    _lastWaits = waits;
+    if (requests == 0 && errors == 0)
+    {
+        // Idle; nothing to learn.
+        return {};
+    }
+    int32_t oldLimit = getLimit();
+    double throughput = static_cast<double>(bytes) / elapsed.count();
+    bool congested = errors > 0;
+    if (requests > 0)
+    {
+        double latency = static_cast<double>(firstByte) / static_cast<double>(requests);
+        // The baseline creeps up slowly so that it can follow a change of route or server.
+        _baseLatency = _baseLatency > 0.0 ? std::min(latency, _baseLatency * 1.01) : latency;
+        congested = congested || latency > _baseLatency * _options.latencyTolerance;
+    }
+    if (congested)
+    {
+        _limit *= _options.decrease;
+    }
+    else if (waiting && throughput >= _lastThroughput * 0.95)
+    {
+        _limit += _options.increase;
+    }
+    _limit = std::clamp(_limit, static_cast<double>(_options.minimum),
+                        static_cast<double>(std::max(_options.minimum, _options.maximum)));
+    _lastThroughput = throughput;
+    int32_t newLimit = getLimit();
+    if (newLimit == oldLimit)
+    {
+        return {};
+    }
+    return newLimit;
+}
+
+AdaptiveHostConcurrency::AdaptiveHostConcurrency(const AdaptiveConcurrencyOptions& options)
+    : _options(options)
+{
+}
+
+void AdaptiveHostConcurrency::update(std::chrono::steady_clock::time_point now,
+                                     const NetworkTelemetry& telemetry,
+                                     HostConcurrency& hostConcurrency)
+{
+    for (const auto& hostName : telemetry.getHosts())
+    {
+        auto hostTelemetry = telemetry.getHost(hostName);
+        if (!hostTelemetry)
+        {
+            continue;
+        }
+        auto itr = _hosts.find(hostName);
+        if (itr == _hosts.end())
+        {
+            AdaptiveConcurrencyOptions hostOptions = _options;
+            long configuredLimit = hostConcurrency.getLimit(hostName);
+            if (configuredLimit > 0)
+            {
+                hostOptions.maximum = std::min(hostOptions.maximum, static_cast<int32_t>(configuredLimit));
+            }
+            ConcurrencyController controller(hostOptions, hostOptions.initial);
+            hostConcurrency.setLimit(hostName, controller.getLimit());
+            itr = _hosts.emplace(hostName, Host{controller, "request limit " + hostName}).first;
+        }
+        Host& host = itr->second;
+        auto newLimit = host.controller.update(now, *hostTelemetry, hostConcurrency.getWaits(hostName));
+        if (newLimit)
+        {
+            VSGCS_PLOT(host.plotName.c_str(), static_cast<int64_t>(*newLimit));
+            hostConcurrency.setLimit(hostName, *newLimit);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "NetworkTelemetry.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace vsgCs
+{
+    class HostConcurrency;
+
+    /**
+     * @brief Bounds and tuning of the adaptive concurrency of the requests to a host.
+     */
+    struct AdaptiveConcurrencyOptions
+    {
+        int32_t minimum = 4;
+        int32_t maximum = 64;
+        // Limit of a host when it is first seen
+        int32_t initial = 20;
+        // Time between adjustments
+        std::chrono::duration<double> interval{1.0};
+        // Back off when the mean time to first byte exceeds the lowest seen by this factor.
+        double latencyTolerance = 2.0;
+        // Added to the limit per interval while throughput keeps up
+        int32_t increase = 2;
+        // Limit is multiplied by this on congestion.
+        double decrease = 0.7;
+    };
+
+    /**
+     * @brief An additive increase / multiplicative decrease controller for the number of
+     * simultaneous requests to one host.
+     *
+     * Each interval it compares the throughput and time to first byte of the host, measured by
+     * the network telemetry, with those of the previous interval. While requests to the host wait
+     * for a free slot and throughput doesn't drop, the limit grows slowly. When the time to first
+     * byte rises well above its baseline, or requests fail, the server or the link is queueing
+     * requests, and the limit is cut.
+     */
+    class ConcurrencyController
+    {
+    public:
+        ConcurrencyController(const AdaptiveConcurrencyOptions& options, int32_t initialLimit);
+        /**
+         * @brief Take a sample if an interval has passed.
+         * @param waits running count of the requests that had to wait for a slot
+         * @return the new limit, if it changed
+         */
+        std::optional<int32_t> update(std::chrono::steady_clock::time_point now,
+                                      const HostTelemetry& telemetry,
+                                      uint64_t waits);
+        int32_t getLimit() const
+        {
+            return static_cast<int32_t>(_limit + 0.5);
+        }
+    private:
+        AdaptiveConcurrencyOptions _options;
+        double _limit;
+        std::optional<std::chrono::steady_clock::time_point> _lastSample;
+        NetworkTelemetry::Totals _lastTotals;
+        uint64_t _lastWaits = 0;
+        double _lastThroughput = 0.0;
+        double _baseLatency = 0.0;
+    };
+
+    /**
+     * @brief Runs a ConcurrencyController for every host in the network telemetry and applies
+     * its limit to the host, so that a slow or congested host only throttles its own requests.
+     *
+     * A limit already set for a host, e.g. in a world's "network" object, caps its adaptive
+     * limit.
+     */
+    class AdaptiveHostConcurrency
+    {
+    public:
+        explicit AdaptiveHostConcurrency(const AdaptiveConcurrencyOptions& options);
+        void update(std::chrono::steady_clock::time_point now,
+                    const NetworkTelemetry& telemetry,
+                    HostConcurrency& hostConcurrency);
+        const AdaptiveConcurrencyOptions& getOptions() const
+        {
+            return _options;
+        }
+    private:
+        struct Host
+        {
+            ConcurrencyController controller;
+            // Tracy needs plot names that live as long as the program.
+            std::string plotName;
+        };
+        AdaptiveConcurrencyOptions _options;
+        std::unordered_map<std::string, Host> _hosts;
+    };
+}
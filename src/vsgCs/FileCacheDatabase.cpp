@@ -0,0 +1,570 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "FileCacheDatabase.h"
+#include "MappedFile.h"
+
+#include <vsg/io/Logger.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ios>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+using namespace vsgCs;
+
+namespace
+{
+    constexpr char entryMagic[4] = {'V', 'C', 'S', 'C'};
+    constexpr uint32_t entryVersion = 1;
+
+    constexpr uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+
+    uint64_t hashKey(const std::string& key, uint64_t basis = fnvOffsetBasis)
+    {
+        // FNV-1a
+        uint64_t result = basis;
+        for (char c : key)
+        {
+            result ^= static_cast<unsigned char>(c);
+            result *= 1099511628211ULL;
+        }
+        return result;
+    }
+
+    // The second slot for a key whose first slot holds a different key
+    uint64_t probeHashKey(const std::string& key)
+    {
+        return hashKey(key, fnvOffsetBasis ^ 0x9e3779b97f4a7c15ULL);
+    }
+
+    std::string hexString(uint64_t hash)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string result(16, '0');
+        for (int i = 15; i >= 0; --i)
+        {
+            result[i] = digits[hash & 0xf];
+            hash >>= 4;
+        }
+        return result;
+    }
+
+    class EntryWriter
+    {
+    public:
+        template<typename T>
+        void write(const T& value)
+        {
+            const char* ptr = reinterpret_cast<const char*>(&value);
+            buffer.append(ptr, ptr + sizeof(T));
+        }
+        void write(const std::string& value)
+        {
+            write(static_cast<uint32_t>(value.size()));
+            buffer.append(value);
+        }
+        void write(const CesiumAsync::HttpHeaders& headers)
+        {
+            write(static_cast<uint32_t>(headers.size()));
+            for (const auto& header : headers)
+            {
+                write(header.first);
+                write(header.second);
+            }
+        }
+        std::string buffer;
+    };
+
+    // Reads values from a mapped entry file, throwing if the file is too short.
+    class EntryReader
+    {
+    public:
+        explicit EntryReader(std::span<const std::byte> data)
+            : _data(data)
+        {
+        }
+        template<typename T>
+        T read()
+        {
+            T result;
+            std::memcpy(&result, take(sizeof(T)), sizeof(T));
+            return result;
+        }
+        std::string readString()
+        {
+            auto size = read<uint32_t>();
+            const auto* ptr = reinterpret_cast<const char*>(take(size));
+            return {ptr, ptr + size};
+        }
+        CesiumAsync::HttpHeaders readHeaders()
+        {
+            CesiumAsync::HttpHeaders result;
+            auto count = read<uint32_t>();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                std::string name = readString();
+                result.emplace(std::move(name), readString());
+            }
+            return result;
+        }
+        std::span<const std::byte> readData(uint64_t size)
+        {
+            return {take(size), size};
+        }
+    private:
+        const std::byte* take(uint64_t size)
+        {
+            if (size > _data.size() - _pos)
+            {
+                throw std::runtime_error("truncated cache entry");
+            }
+            const std::byte* result = _data.data() + _pos;
+            _pos += size;
+            return result;
+        }
+        std::span<const std::byte> _data;
+        size_t _pos = 0;
+    };
+
+    struct EntryHeader
+    {
+        std::time_t expiryTime;
+        uint16_t statusCode;
+        std::string key;
+    };
+
+    std::optional<EntryHeader> readEntryHeader(EntryReader& reader)
+    {
+        char magic[4];
+        for (char& c : magic)
+        {
+            c = reader.read<char>();
+        }
+        if (std::memcmp(magic, entryMagic, sizeof(magic)) != 0 || reader.read<uint32_t>() != entryVersion)
+        {
+            return std::nullopt;
+        }
+        auto expiryTime = static_cast<std::time_t>(reader.read<int64_t>());
+        auto statusCode = reader.read<uint16_t>();
+        return EntryHeader{expiryTime, statusCode, reader.readString()};
+    }
+}
+
+FileCacheDatabase::FileCacheDatabase(const std::filesystem::path& directory, uint64_t maxBytes)
+    : _directory(directory), _maxBytes(maxBytes)
+{
+    std::filesystem::create_directories(_directory);
+    removeTempFiles();
+    loadIndex();
+    compactIndex();
+}
+
+FileCacheDatabase::~FileCacheDatabase()
+{
+    flushAccesses();
+}
+
+std::filesystem::path FileCacheDatabase::getEntryPath(uint64_t hash) const
+{
+    std::string name = hexString(hash);
+    return _directory / name.substr(0, 2) / name;
+}
+
+void FileCacheDatabase::addEntry(uint64_t hash, uint64_t size, int64_t access)
+{
+    Shard& shard = getShard(hash);
+    std::unique_lock lock(shard.mutex);
+    auto itr = shard.entries.find(hash);
+    if (itr != shard.entries.end())
+    {
+        _totalBytes -= itr->second.size;
+        shard.entries.erase(itr);
+    }
+    shard.entries.try_emplace(hash, size, access);
+    _totalBytes += size;
+}
+
+void FileCacheDatabase::removeEntry(uint64_t hash)
+{
+    Shard& shard = getShard(hash);
+    std::unique_lock lock(shard.mutex);
+    auto itr = shard.entries.find(hash);
+    if (itr != shard.entries.end())
+    {
+        _totalBytes -= itr->second.size;
+        shard.entries.erase(itr);
+    }
+}
+
+void FileCacheDatabase::removeTempFiles()
+{
+    std::error_code ec;
+    std::vector<std::filesystem::path> tempFiles;
+    for (auto itr = std::filesystem::recursive_directory_iterator(_directory, ec);
+         !ec && itr != std::filesystem::recursive_directory_iterator();
+         itr.increment(ec))
+    {
+        if (itr->path().extension() == ".tmp")
+        {
+            tempFiles.push_back(itr->path());
+        }
+    }
+    for (const auto& path : tempFiles)
+    {
+        std::filesystem::remove(path, ec);
+    }
+}
+
+void FileCacheDatabase::loadIndex()
+{
+    std::ifstream index(_directory / "index.log");
+    std::string line;
+    while (std::getline(index, line))
+    {
+        std::istringstream record(line);
+        char op = 0;
+        std::string hashString;
+        uint64_t size = 0;
+        record >> op >> hashString;
+        uint64_t hash = 0;
+        // A damaged record is skipped, not allowed to make the cache unusable.
+        if (hashString.size() != 16
+            || std::from_chars(hashString.data(), hashString.data() + hashString.size(), hash, 16).ptr
+            != hashString.data() + hashString.size())
+        {
+            continue;
+        }
+        if (op == '+' && (record >> size))
+        {
+            // Later records in the log are more recent.
+            addEntry(hash, size, _clock++);
+        }
+        else if (op == '-')
+        {
+            removeEntry(hash);
+        }
+        else if (op == '*')
+        {
+            Shard& shard = getShard(hash);
+            std::shared_lock lock(shard.mutex);
+            auto itr = shard.entries.find(hash);
+            if (itr != shard.entries.end())
+            {
+                itr->second.lastAccess = _clock++;
+            }
+        }
+    }
+}
+
+void FileCacheDatabase::appendIndex(char op, uint64_t hash, uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    _index << op << ' ' << hexString(hash);
+    if (op == '+')
+    {
+        _index << ' ' << size;
+    }
+    _index << '\n';
+    _index.flush();
+    ++_indexRecords;
+}
+
+// Reads are logged in batches, as getEntry() is much more frequent than storeEntry().
+
+void FileCacheDatabase::recordAccess(uint64_t hash) const
+{
+    std::unique_lock lock(_accessMutex);
+    _accesses.push_back(hash);
+    if (_accesses.size() >= accessBatchSize)
+    {
+        lock.unlock();
+        const_cast<FileCacheDatabase*>(this)->flushAccesses();
+    }
+}
+
+void FileCacheDatabase::flushAccesses()
+{
+    std::vector<uint64_t> accesses;
+    {
+        std::lock_guard<std::mutex> lock(_accessMutex);
+        accesses.swap(_accesses);
+    }
+    if (accesses.empty())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    for (uint64_t hash : accesses)
+    {
+        _index << "* " << hexString(hash) << '\n';
+    }
+    _index.flush();
+    _indexRecords += accesses.size();
+}
+
+bool FileCacheDatabase::hasEntry(uint64_t hash) const
+{
+    Shard& shard = getShard(hash);
+    std::shared_lock lock(shard.mutex);
+    return shard.entries.find(hash) != shard.entries.end();
+}
+
+std::optional<std::string> FileCacheDatabase::readEntryKey(uint64_t hash) const
+{
+    try
+    {
+        auto file = MappedFile::open(getEntryPath(hash).string());
+        EntryReader reader(file->data());
+        auto header = readEntryHeader(reader);
+        if (header)
+        {
+            return std::move(header->key);
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+    return std::nullopt;
+}
+
+uint64_t FileCacheDatabase::chooseSlot(const std::string& key) const
+{
+    uint64_t hash = hashKey(key);
+    uint64_t probeHash = probeHashKey(key);
+    if (hasEntry(probeHash) && readEntryKey(probeHash) == key)
+    {
+        return probeHash;
+    }
+    if (!hasEntry(hash))
+    {
+        return hash;
+    }
+    // An unreadable entry is replaced.
+    auto storedKey = readEntryKey(hash);
+    return !storedKey || *storedKey == key ? hash : probeHash;
+}
+
+void FileCacheDatabase::compactIndex()
+{
+    // Least recently used first, so that reloading the index preserves the LRU order.
+    std::vector<std::tuple<int64_t, uint64_t, uint64_t>> entries;
+    for (auto& shard : _shards)
+    {
+        std::shared_lock lock(shard.mutex);
+        for (const auto& [hash, info] : shard.entries)
+        {
+            entries.emplace_back(info.lastAccess.load(), hash, info.size);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    {
+        // The rewritten log has the reads' order.
+        std::lock_guard<std::mutex> lock(_accessMutex);
+        _accesses.clear();
+    }
+    std::lock_guard<std::mutex> lock(_indexMutex);
+    _index.close();
+    auto tempPath = _directory / "index.log.tmp";
+    {
+        std::ofstream temp(tempPath, std::ios::trunc);
+        for (const auto& [access, hash, size] : entries)
+        {
+            temp << "+ " << hexString(hash) << ' ' << size << '\n';
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, _directory / "index.log", ec);
+    if (ec)
+    {
+        vsg::warn("FileCacheDatabase: can't write index in ", _directory.string(), ": ", ec.message());
+    }
+    _index.open(_directory / "index.log", std::ios::app);
+    _indexRecords = entries.size();
+}
+
+std::optional<CesiumAsync::CacheItem> FileCacheDatabase::getEntry(const std::string& key) const
+{
+    for (uint64_t hash : {hashKey(key), probeHashKey(key)})
+    {
+        if (!hasEntry(hash))
+        {
+            continue;
+        }
+        std::shared_ptr<MappedFile> file;
+        try
+        {
+            file = MappedFile::open(getEntryPath(hash).string());
+            EntryReader reader(file->data());
+            auto header = readEntryHeader(reader);
+            if (!header || header->key != key)
+            {
+                // Hash collision; the key may be in its second slot.
+                continue;
+            }
+            std::string url = reader.readString();
+            std::string method = reader.readString();
+            CesiumAsync::HttpHeaders requestHeaders = reader.readHeaders();
+            CesiumAsync::HttpHeaders responseHeaders = reader.readHeaders();
+            auto data = reader.readData(reader.read<uint64_t>());
+            {
+                Shard& shard = getShard(hash);
+                std::shared_lock lock(shard.mutex);
+                auto itr = shard.entries.find(hash);
+                if (itr != shard.entries.end())
+                {
+                    itr->second.lastAccess = _clock++;
+                }
+            }
+            recordAccess(hash);
+            return CesiumAsync::CacheItem(header->expiryTime,
+                                          CesiumAsync::CacheRequest(std::move(requestHeaders),
+                                                                    std::move(method), std::move(url)),
+                                          CesiumAsync::CacheResponse(header->statusCode,
+                                                                     std::move(responseHeaders),
+                                                                     std::vector<std::byte>(data.begin(),
+                                                                                            data.end())));
+        }
+        catch (const std::exception& e)
+        {
+            vsg::warn("FileCacheDatabase: can't read entry for ", key, ": ", e.what());
+            const_cast<FileCacheDatabase*>(this)->removeEntry(hash);
+        }
+    }
+    return std::nullopt;
+}
+
+bool FileCacheDatabase::storeEntry(const std::string& key,
+                                   std::time_t expiryTime,
+                                   const std::string& url,
+                                   const std::string& requestMethod,
+                                   const CesiumAsync::HttpHeaders& requestHeaders,
+                                   uint16_t statusCode,
+                                   const CesiumAsync::HttpHeaders& responseHeaders,
+                                   const std::span<const std::byte>& responseData)
+{
+    uint64_t hash = chooseSlot(key);
+    EntryWriter writer;
+    writer.buffer.append(entryMagic, sizeof(entryMagic));
+    writer.write(entryVersion);
+    writer.write(static_cast<int64_t>(expiryTime));
+    writer.write(statusCode);
+    writer.write(key);
+    writer.write(url);
+    writer.write(requestMethod);
+    writer.write(requestHeaders);
+    writer.write(responseHeaders);
+    writer.write(static_cast<uint64_t>(responseData.size()));
+    auto path = getEntryPath(hash);
+    auto tempPath = path;
+    tempPath += "." + std::to_string(_tempCounter++) + ".tmp";
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(writer.buffer.data(), static_cast<std::streamsize>(writer.buffer.size()));
+        out.write(reinterpret_cast<const char*>(responseData.data()),
+                  static_cast<std::streamsize>(responseData.size()));
+        if (!out)
+        {
+            vsg::warn("FileCacheDatabase: can't write ", tempPath.string());
+            out.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+    // Readers see either the old file or the new one, never a partial write.
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        vsg::warn("FileCacheDatabase: can't store ", path.string(), ": ", ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    uint64_t size = writer.buffer.size() + responseData.size();
+    addEntry(hash, size, _clock++);
+    appendIndex('+', hash, size);
+    return true;
+}
+
+bool FileCacheDatabase::prune()
+{
+    if (_totalBytes <= _maxBytes)
+    {
+        return true;
+    }
+    std::vector<std::tuple<int64_t, uint64_t>> entries;
+    for (auto& shard : _shards)
+    {
+        std::shared_lock lock(shard.mutex);
+        for (const auto& [hash, info] : shard.entries)
+        {
+            entries.emplace_back(info.lastAccess.load(), hash);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    // Leave some room so that every store doesn't trigger another prune.
+    const uint64_t target = _maxBytes - _maxBytes / 10;
+    for (const auto& [access, hash] : entries)
+    {
+        if (_totalBytes <= target)
+        {
+            break;
+        }
+        std::error_code ec;
+        std::filesystem::remove(getEntryPath(hash), ec);
+        removeEntry(hash);
+        appendIndex('-', hash, 0);
+    }
+    size_t indexRecords = 0;
+    {
+        std::lock_guard<std::mutex> lock(_indexMutex);
+        indexRecords = _indexRecords;
+    }
+    if (indexRecords > 2 * entries.size() + 1024)
+    {
+        compactIndex();
+    }
+    return true;
+}
+
+bool FileCacheDatabase::clearAll()
+{
+    for (auto& shard : _shards)
+    {
+        std::unique_lock lock(shard.mutex);
+        for (const auto& entry : shard.entries)
+        {
+            std::error_code ec;
+            std::filesystem::remove(getEntryPath(entry.first), ec);
+            _totalBytes -= entry.second.size;
+        }
+        shard.entries.clear();
+    }
+    compactIndex();
+    return true;
+}
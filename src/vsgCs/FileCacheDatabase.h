@@ -0,0 +1,137 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <CesiumAsync/CacheItem.h>
+#include <CesiumAsync/ICacheDatabase.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vsgCs
+{
+    /**
+     * @brief A cache database that stores each response in its own file.
+     *
+     * Files are named by a hash of the cache key and spread over 256 subdirectories; a key whose
+     * hash collides with another key's is stored under a second, differently seeded hash. A
+     * response is written to a temporary file and renamed into place, so readers never see a
+     * partial entry and don't need to take any file locks; reads map the file. An append-only index
+     * log records the entries, their sizes and, in batches, the reads, so that the least recently
+     * used entries can be evicted when the cache grows past its size limit, also after a restart.
+     *
+     * Unlike SqliteCache, writers of different entries don't contend with each other.
+     */
+    class VSGCS_EXPORT FileCacheDatabase : public CesiumAsync::ICacheDatabase
+    {
+    public:
+        /**
+         * @param directory root directory of the cache, created if it doesn't exist.
+         * @param maxBytes prune() evicts entries until the cache is smaller than this.
+         */
+        FileCacheDatabase(const std::filesystem::path& directory, uint64_t maxBytes);
+        ~FileCacheDatabase() override;
+
+        std::optional<CesiumAsync::CacheItem> getEntry(const std::string& key) const override;
+        bool storeEntry(const std::string& key,
+                        std::time_t expiryTime,
+                        const std::string& url,
+                        const std::string& requestMethod,
+                        const CesiumAsync::HttpHeaders& requestHeaders,
+                        uint16_t statusCode,
+                        const CesiumAsync::HttpHeaders& responseHeaders,
+                        const std::span<const std::byte>& responseData) override;
+        bool prune() override;
+        bool clearAll() override;
+
+        /**
+         * @brief Total size of the cached files.
+         */
+        uint64_t getSize() const
+        {
+            return _totalBytes.load();
+        }
+    private:
+        struct EntryInfo
+        {
+            explicit EntryInfo(uint64_t in_size, int64_t access)
+                : size(in_size), lastAccess(access)
+            {
+            }
+            uint64_t size;
+            mutable std::atomic<int64_t> lastAccess;
+        };
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<uint64_t, EntryInfo> entries;
+        };
+        static constexpr size_t numShards = 64;
+        // Number of reads recorded in the index log at once
+        static constexpr size_t accessBatchSize = 256;
+        std::filesystem::path getEntryPath(uint64_t hash) const;
+        Shard& getShard(uint64_t hash) const
+        {
+            return _shards[hash % numShards];
+        }
+        void loadIndex();
+        // Remove the temporary files left by interrupted writes.
+        void removeTempFiles();
+        void appendIndex(char op, uint64_t hash, uint64_t size);
+        void recordAccess(uint64_t hash) const;
+        void flushAccesses();
+        bool hasEntry(uint64_t hash) const;
+        // The key stored in an entry file, if the file is readable.
+        std::optional<std::string> readEntryKey(uint64_t hash) const;
+        // The hash under which to store key.
+        uint64_t chooseSlot(const std::string& key) const;
+        // Rewrite the index log from the in-memory entries.
+        void compactIndex();
+        void addEntry(uint64_t hash, uint64_t size, int64_t access);
+        void removeEntry(uint64_t hash);
+        std::filesystem::path _directory;
+        uint64_t _maxBytes;
+        mutable Shard _shards[numShards];
+        std::atomic<uint64_t> _totalBytes{0};
+        mutable std::atomic<int64_t> _clock{0};
+        std::mutex _indexMutex;
+        std::ofstream _index;
+        size_t _indexRecords = 0;
+        mutable std::mutex _accessMutex;
+        mutable std::vector<uint64_t> _accesses;
+        std::atomic<uint64_t> _tempCounter{0};
+    };
+}
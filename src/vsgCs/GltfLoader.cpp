@@ -115,16 +115,9 @@ GltfLoader::read(const vsg::Path& path, vsg::ref_ptr<const vsg::Options> options
         uriPath = "file://" + absPath.string();
     }
     auto future = loadGltfNode(uriPath);
-    if (isMainThread())
-    {
-        // Can't block the dispatch of main thread tasks
-        while (!future.isReady())
-        {
-            getAsyncSystem().dispatchMainThreadTasks();
-        }
-    }
-
-    auto loadResult = future.wait();
+    // Can't block the dispatch of main thread tasks. waitInMainThread() runs them as they are
+    // queued and otherwise sleeps on a condition variable until the future resolves.
+    auto loadResult = isMainThread() ? future.waitInMainThread() : future.wait();
 
     return loadResult.node;
 }
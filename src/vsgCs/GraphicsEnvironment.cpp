@@ -23,8 +23,11 @@ SOFTWARE.
 </editor-fold> */
 
 #include "GraphicsEnvironment.h"
+#include "OverlayTextureTable.h"
+#include "TileParameterBuffer.h"
 #include "pbr.h"
 #include "runtimeSupport.h"
+#include "Tracing.h"
 
 using namespace vsgCs;
 
@@ -52,7 +55,7 @@ namespace
         auto hints = vsg::ResourceHints::create();
         hints->numDescriptorSets = 1024; // who knows
         VkDescriptorPoolSize samplers = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, pbr::maxOverlays * 1024};
-        VkDescriptorPoolSize buffers = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1024};
+        VkDescriptorPoolSize buffers = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1024};
         hints->descriptorPoolSizes.push_back(samplers);
         hints->descriptorPoolSizes.push_back(buffers);
         return vsg::ResourceRequirements(hints);
@@ -65,75 +68,164 @@ GraphicsEnvironment::GraphicsEnvironment(const vsg::ref_ptr<vsg::Options> &vsgOp
     : shaderFactory(ShaderFactory::create(vsgOptions)), features(in_features),
       sharedObjects(create_or<vsg::SharedObjects>(vsgOptions->sharedObjects)),
       device(in_device),
-      defaultTexture(makeDefaultTexture())
+      defaultTexture(makeDefaultTexture()),
+      tileParameters(TileParameterBuffer::create(in_device))
 {
     std::set<std::string> shaderDefines;
     shaderDefines.insert({"VSG_TWO_SIDED_LIGHTING", "VSGCS_OVERLAY_MAPS", "VSGCS_LOD_FADE"});
+    if (features.overlayTextureTable)
+    {
+        shaderDefines.insert("VSGCS_OVERLAY_TABLE");
+    }
     // We only care about the layout of the first three descriptor sets. All the model-specific
     // descriptors are in the fourth set, so we can get the layout for a "generic" shader and use it
     // for lighting and whole-tile parameters.
     auto defaultShaderSet = shaderFactory->getShaderSet(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
     overlayPipelineLayout = defaultShaderSet->createPipelineLayout(shaderDefines,
                                                                    {0, pbr::TILE_DESCRIPTOR_SET + 1});
-    miniCompileTraversal = vsg::CompileTraversal::create(device, getMiniCompileRequirements());
+    _idleMiniCompiles.push_back(vsg::CompileTraversal::create(device, getMiniCompileRequirements()));
     auto noiseBytes = readBinaryFile("images/LDR_LLL1_0.png", vsgOptions);
     blueNoiseTexture = makeImage(noiseBytes, false, true,
                                  VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT,
                                  VK_FILTER_NEAREST, VK_FILTER_NEAREST);
+    if (features.overlayTextureTable)
+    {
+        overlayTable = OverlayTextureTable::create(*this);
+    }
+}
+
+GraphicsEnvironment::~GraphicsEnvironment()
+{
+    for (auto& pending : _pendingMiniCompiles)
+    {
+        pending.traversal->waitForCompletion();
+    }
+}
+
+vsg::ref_ptr<vsg::CompileTraversal> GraphicsEnvironment::acquireMiniCompileTraversal(const FrameProgress& progress)
+{
+    // Enough for the frames in flight; beyond that, waiting for the oldest is better than
+    // allocating more descriptor pools.
+    const size_t maxPendingMiniCompiles = 4;
+    while (!_pendingMiniCompiles.empty() && progress.isComplete(_pendingMiniCompiles.front().frameCount))
+    {
+        // The commands are finished, so this only resets the traversal.
+        _pendingMiniCompiles.front().traversal->waitForCompletion();
+        _idleMiniCompiles.push_back(_pendingMiniCompiles.front().traversal);
+        _pendingMiniCompiles.pop_front();
+    }
+    vsg::ref_ptr<vsg::CompileTraversal> result;
+    if (!_idleMiniCompiles.empty())
+    {
+        result = _idleMiniCompiles.back();
+        _idleMiniCompiles.pop_back();
+    }
+    else if (_pendingMiniCompiles.size() < maxPendingMiniCompiles)
+    {
+        result = vsg::CompileTraversal::create(device, getMiniCompileRequirements());
+    }
+    else
+    {
+        VSGCS_ZONESCOPEDN("wait for miniCompile");
+        result = _pendingMiniCompiles.front().traversal;
+        _pendingMiniCompiles.pop_front();
+        result->waitForCompletion();
+    }
+    return result;
 }
 
 // Copied from vsg::CompileManager
 
-vsg::CompileResult GraphicsEnvironment::miniCompile(vsg::ref_ptr<vsg::Object> object)
+vsg::CompileResult GraphicsEnvironment::miniCompile(const MiniCompileBatch& batch, const FrameProgress& progress)
 {
+    VSGCS_ZONESCOPED;
+    vsg::CompileResult result;
+    if (batch.empty())
+    {
+        return result;
+    }
     vsg::CollectResourceRequirements collectRequirements;
-    object->accept(collectRequirements);
+    for (const auto& object : batch.compileObjects)
+    {
+        object->accept(collectRequirements);
+    }
+    // Images in rewritten descriptor sets may not be compiled yet.
+    for (const auto& descriptorSet : batch.rewriteObjects)
+    {
+        descriptorSet->accept(collectRequirements);
+    }
 
     auto& requirements = collectRequirements.requirements;
     auto& viewDetailsStack = requirements.viewDetailsStack;
 
-    vsg::CompileResult result;
     result.maxSlots = requirements.maxSlots;
     result.containsPagedLOD = requirements.containsPagedLOD;
     result.views = requirements.views;
     result.dynamicData= requirements.dynamicData;
 
-    auto run_compile_traversal = [&]() -> void {
-        for (auto& context : miniCompileTraversal->contexts)
+    auto traversal = acquireMiniCompileTraversal(progress);
+    for (auto& context : traversal->contexts)
+    {
+        vsg::ref_ptr<vsg::View> view = context->view;
+        if (view && !viewDetailsStack.empty())
         {
-            vsg::ref_ptr<vsg::View> view = context->view;
-            if (view && !viewDetailsStack.empty())
+            if (auto itr = result.views.find(view.get()); itr == result.views.end())
             {
-                if (auto itr = result.views.find(view.get()); itr == result.views.end())
-                {
-                    result.views[view] = viewDetailsStack.top();
-                }
+                result.views[view] = viewDetailsStack.top();
             }
-
-            context->reserve(requirements);
         }
 
-        object->accept(*miniCompileTraversal);
-
-        //debug("Finished compile traversal ", object);
+        context->reserve(requirements);
+    }
 
-        if (miniCompileTraversal->record())
+    for (const auto& object : batch.compileObjects)
+    {
+        object->accept(*traversal);
+    }
+    for (auto& context : traversal->contexts)
+    {
+        for (const auto& descriptorSet : batch.rewriteObjects)
         {
-            // This happens on startup. I think it's caused by the default texture.
-            vsg::warn("miniCompile did recording!");
+            descriptorSet->rewrite(*context);
         }
-
-        miniCompileTraversal->waitForCompletion();
-
-        debug("Finished waiting for compile ", object);
-    };
-
-    run_compile_traversal();
+    }
+    if (traversal->record())
+    {
+        // Submitted before the frame being updated, so the traversal can be reused when that
+        // frame is complete.
+        _pendingMiniCompiles.push_back(PendingMiniCompile{traversal, progress.frameCount});
+    }
+    else
+    {
+        _idleMiniCompiles.push_back(traversal);
+    }
+    VSGCS_PLOT("pending miniCompiles", static_cast<int64_t>(_pendingMiniCompiles.size()));
 
     result.result = VK_SUCCESS;
     return result;
 }
 
+RewritableDescriptorSet::RewritableDescriptorSet(const vsg::ref_ptr<vsg::DescriptorSetLayout>& in_descriptorSetLayout,
+                                                 const vsg::Descriptors& in_descriptors)
+    : Inherit(in_descriptorSetLayout, in_descriptors)
+{
+}
+
+void RewritableDescriptorSet::rewrite(vsg::Context& context)
+{
+    auto& implementation = _implementation[context.deviceID];
+    if (!implementation)
+    {
+        compile(context);
+        return;
+    }
+    for (auto& descriptor : descriptors)
+    {
+        descriptor->compile(context);
+    }
+    implementation->assign(context, descriptors);
+}
+
 namespace vsgCs
 {
     vsg::ref_ptr<vsg::DescriptorSet>
@@ -30,13 +30,21 @@ SOFTWARE.
 #include <CesiumGltf/Ktx2TranscodeTargets.h>
 
 #include <vsg/app/CompileManager.h>
+#include <vsg/state/DescriptorSet.h>
 #include <vsg/state/ImageInfo.h>
 #include <vsg/utils/GraphicsPipelineConfigurator.h>
 #include <vsg/utils/SharedObjects.h>
 #include <vsg/vk/Context.h>
 
+#include <deque>
+#include <optional>
+#include <vector>
+
 namespace vsgCs
 {
+    class OverlayTextureTable;
+    class TileParameterBuffer;
+
     /**
      * @brief A compact representation of supported Vulkan features that are important to vsgCs.
      */
@@ -50,6 +58,8 @@ namespace vsgCs
         bool textureCompressionBC = false;
         bool textureCompressionPVRTC = false;
         bool depthClamp = false;
+        // Dynamically indexed sampler arrays are supported and the overlay texture table was requested.
+        bool overlayTextureTable = false;
         CesiumGltf::Ktx2TranscodeTargets ktx2TranscodeTargets;
         float pointSizeRange[2];
         PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT vkGetPhysicalDeviceCalibrateableTimeDomainsEXT
@@ -57,15 +67,64 @@ namespace vsgCs
         PFN_vkGetCalibratedTimestampsEXT vkGetCalibratedTimestampsEXT = nullptr;
     };
 
+    /**
+     * @brief A descriptor set whose Vulkan descriptor set can be rewritten in place after it has
+     * been compiled, instead of allocating a new one.
+     */
+    class VSGCS_EXPORT RewritableDescriptorSet : public vsg::Inherit<vsg::DescriptorSet, RewritableDescriptorSet>
+    {
+    public:
+        RewritableDescriptorSet(const vsg::ref_ptr<vsg::DescriptorSetLayout>& in_descriptorSetLayout,
+                                const vsg::Descriptors& in_descriptors);
+        /**
+         * @brief Write the current descriptors to the Vulkan descriptor set. The set must not be
+         * used by any command buffer that is still pending.
+         */
+        void rewrite(vsg::Context& context);
+    };
+
+    // Where the GPU is, for reusing Vulkan objects that may be referenced by earlier frames.
+    struct FrameProgress
+    {
+        uint64_t frameCount = 0;
+        // Every frame up to this one is finished on the GPU.
+        std::optional<uint64_t> completedFrame;
+        bool isComplete(uint64_t frame) const
+        {
+            return completedFrame && frame <= *completedFrame;
+        }
+    };
+
+    /**
+     * @brief Objects to compile, and compiled descriptor sets to write again, in one
+     * GraphicsEnvironment::miniCompile() call.
+     */
+    struct MiniCompileBatch
+    {
+        std::vector<vsg::ref_ptr<vsg::Object>> compileObjects;
+        std::vector<vsg::ref_ptr<RewritableDescriptorSet>> rewriteObjects;
+        bool empty() const
+        {
+            return compileObjects.empty() && rewriteObjects.empty();
+        }
+    };
+
     class VSGCS_EXPORT GraphicsEnvironment : public vsg::Inherit<vsg::Object, GraphicsEnvironment>
     {
     public:
         GraphicsEnvironment(const vsg::ref_ptr<vsg::Options>& vsgOptions, const DeviceFeatures& in_features,
                             const vsg::ref_ptr<vsg::Device>& in_device);
+        ~GraphicsEnvironment() override;
         /**
-         * @brief Run a compile traversal with a minimal context for updating Vulkan handles and such.
+         * @brief Run a compile traversal with a minimal context for updating Vulkan handles and
+         * such, and rewrite descriptor sets in place.
+         *
+         * This doesn't wait for the GPU. Any transfer commands are submitted to the graphics
+         * queue, so the frame being updated, which is submitted later, sees their results. The
+         * traversal is reused after that frame is complete. The result should be passed to
+         * vsg::updateViewer() in a later frame.
          */
-        vsg::CompileResult miniCompile(vsg::ref_ptr<vsg::Object> object);
+        vsg::CompileResult miniCompile(const MiniCompileBatch& batch, const FrameProgress& progress);
         vsg::ref_ptr<ShaderFactory> shaderFactory;
         const DeviceFeatures features;
         vsg::ref_ptr<vsg::SharedObjects> sharedObjects;
@@ -82,8 +141,24 @@ namespace vsgCs
          */
         vsg::ref_ptr<vsg::PipelineLayout> overlayPipelineLayout;
         vsg::ref_ptr<vsg::ImageInfo> blueNoiseTexture;
+        /**
+         * @brief The table of all overlay images, if DeviceFeatures::overlayTextureTable is set.
+         */
+        vsg::ref_ptr<OverlayTextureTable> overlayTable;
+        /**
+         * @brief The parameters of all the tiles
+         */
+        vsg::ref_ptr<TileParameterBuffer> tileParameters;
     protected:
-        vsg::ref_ptr<vsg::CompileTraversal> miniCompileTraversal;
+        vsg::ref_ptr<vsg::CompileTraversal> acquireMiniCompileTraversal(const FrameProgress& progress);
+        struct PendingMiniCompile
+        {
+            vsg::ref_ptr<vsg::CompileTraversal> traversal;
+            uint64_t frameCount;
+        };
+        // Traversals whose commands may still be executing, oldest first
+        std::deque<PendingMiniCompile> _pendingMiniCompiles;
+        std::vector<vsg::ref_ptr<vsg::CompileTraversal>> _idleMiniCompiles;
     };
 
     // Utility
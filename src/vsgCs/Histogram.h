@@ -0,0 +1,142 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace vsgCs
+{
+    /**
+     * @brief A lock-free histogram of non-negative integer values, e.g. times in microseconds.
+     *
+     * Values are counted in power-of-two buckets: bucket 0 holds 0 and bucket i holds values in
+     * [2^(i-1), 2^i). Any number of threads can record values concurrently; readers see a
+     * consistent enough view for statistics, though not an atomic snapshot.
+     */
+    class Histogram
+    {
+    public:
+        static constexpr size_t numBuckets = 65;
+
+        void record(uint64_t value)
+        {
+            _buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+            uint64_t oldMin = _min.load(std::memory_order_relaxed);
+            while (value < oldMin
+                   && !_min.compare_exchange_weak(oldMin, value, std::memory_order_relaxed))
+            {
+            }
+            uint64_t oldMax = _max.load(std::memory_order_relaxed);
+            while (value > oldMax
+                   && !_max.compare_exchange_weak(oldMax, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        uint64_t count() const
+        {
+            return _count.load(std::memory_order_relaxed);
+        }
+
+        uint64_t sum() const
+        {
+            return _sum.load(std::memory_order_relaxed);
+        }
+
+        double mean() const
+        {
+            uint64_t n = count();
+            return n == 0 ? 0.0 : static_cast<double>(sum()) / static_cast<double>(n);
+        }
+
+        uint64_t min() const
+        {
+            return count() == 0 ? 0 : _min.load(std::memory_order_relaxed);
+        }
+
+        uint64_t max() const
+        {
+            return _max.load(std::memory_order_relaxed);
+        }
+
+        uint64_t bucketCount(size_t bucket) const
+        {
+            return _buckets[bucket].load(std::memory_order_relaxed);
+        }
+
+        // Smallest value that can be counted in bucket.
+        static uint64_t bucketLowerBound(size_t bucket)
+        {
+            return bucket == 0 ? 0 : uint64_t(1) << (bucket - 1);
+        }
+
+        /**
+         * @brief An estimate of the value below which fraction (0 - 1) of the values fall,
+         * interpolated within the bucket that contains it.
+         */
+        uint64_t percentile(double fraction) const
+        {
+            uint64_t n = count();
+            if (n == 0)
+            {
+                return 0;
+            }
+            auto rank = static_cast<uint64_t>(fraction * static_cast<double>(n));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < numBuckets; ++i)
+            {
+                uint64_t inBucket = bucketCount(i);
+                if (inBucket > 0 && seen + inBucket > rank)
+                {
+                    uint64_t low = bucketLowerBound(i);
+                    uint64_t high = i + 1 < numBuckets ? bucketLowerBound(i + 1) : max();
+                    double within = static_cast<double>(rank - seen) / static_cast<double>(inBucket);
+                    auto result = low + static_cast<uint64_t>(within * static_cast<double>(high - low));
+                    return std::min(std::max(result, min()), max());
+                }
+                seen += inBucket;
+            }
+            return max();
+        }
+
+        static size_t bucketIndex(uint64_t value)
+        {
+            return static_cast<size_t>(std::bit_width(value));
+        }
+    private:
+        std::array<std::atomic<uint64_t>, numBuckets> _buckets{};
+        std::atomic<uint64_t> _count{0};
+        std::atomic<uint64_t> _sum{0};
+        std::atomic<uint64_t> _min{std::numeric_limits<uint64_t>::max()};
+        std::atomic<uint64_t> _max{0};
+    };
+}
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <glm/mat4x4.hpp>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -19,10 +20,13 @@
 
 namespace vsgCs
 {
+    struct UploadBatch;
+
     struct LoadModelResult
     {
         vsg::ref_ptr<vsg::Node> modelResult;
-        vsg::CompileResult compileResult;
+        // Compile result of the batch that the model was compiled in
+        std::shared_ptr<UploadBatch> compileResult;
     };
 
     // Reference to model that is kept in a Cesium Tile as a pointer to void.
@@ -30,6 +34,8 @@ namespace vsgCs
     struct RenderResources
     {
         vsg::ref_ptr<vsg::Node> model;
+        // The tile's slot in the TileParameterBuffer
+        uint32_t parameterSlot = 0;
     };
 
     // Not a great place for this definition, but it is "low level."
@@ -42,7 +48,7 @@ namespace vsgCs
     struct LoadRasterResult
     {
         vsg::ref_ptr<vsg::ImageInfo> rasterResult;
-        vsg::CompileResult compileResult;
+        std::shared_ptr<UploadBatch> compileResult;
         // trick Cesium into passing our overlay options back to us.
         OverlayRendererOptions overlayOptions;
     };
@@ -51,5 +57,7 @@ namespace vsgCs
     {
         vsg::ref_ptr<vsg::ImageInfo> raster;
         OverlayRendererOptions overlayOptions;
+        // Index in the overlay texture table, if it is used
+        uint32_t tableIndex = 0;
     };
 }
@@ -0,0 +1,127 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#include "MainThreadScheduler.h"
+#include "OpThreadTaskProcessor.h"
+#include "Tracing.h"
+
+#include <algorithm>
+
+using namespace vsgCs;
+
+namespace
+{
+    // Frames later than the target period by this factor cut the budget.
+    const double lateFrameFactor = 1.1;
+    const double budgetDecrease = 0.75;
+    // Added to the budget each frame that is on time, as a share of the frame period
+    const double budgetIncrease = 0.02;
+    // Weight of the latest frame in the smoothed frame time
+    const double frameTimeSmoothing = 0.5;
+}
+
+namespace vsgCs
+{
+    MainThreadScheduler& getMainThreadScheduler()
+    {
+        static MainThreadScheduler scheduler;
+        return scheduler;
+    }
+}
+
+void MainThreadScheduler::setOptions(const FrameBudgetOptions& options)
+{
+    _options = options;
+    if (_options.targetFrameRate > 0.0)
+    {
+        // Start high and let late frames bring the budget down.
+        _budget = std::max(_options.minimumBudget, _options.maximumShare * 1000.0 / _options.targetFrameRate);
+    }
+    else
+    {
+        _budget = _options.budget;
+    }
+}
+
+void MainThreadScheduler::beginFrame(uint64_t frameCount, clock::time_point frameTime)
+{
+    if (_frameCount && *_frameCount == frameCount)
+    {
+        return;
+    }
+    _frameCount = frameCount;
+    _spent = 0.0;
+    if (_lastFrameTime)
+    {
+        std::chrono::duration<double, std::milli> interval = frameTime - *_lastFrameTime;
+        _frameTime = _frameTime == 0.0
+            ? interval.count()
+            : frameTimeSmoothing * interval.count() + (1.0 - frameTimeSmoothing) * _frameTime;
+    }
+    _lastFrameTime = frameTime;
+    if (_options.targetFrameRate > 0.0 && _frameTime > 0.0)
+    {
+        double period = 1000.0 / _options.targetFrameRate;
+        if (_frameTime > period * lateFrameFactor)
+        {
+            _budget *= budgetDecrease;
+        }
+        else
+        {
+            _budget += budgetIncrease * period;
+        }
+        _budget = std::clamp(_budget, _options.minimumBudget,
+                             std::max(_options.minimumBudget, _options.maximumShare * period));
+    }
+    VSGCS_PLOT("main thread budget", _budget);
+}
+
+void MainThreadScheduler::dispatch()
+{
+    VSGCS_ZONESCOPEDN("main thread tasks");
+    auto& asyncSystem = getAsyncSystem();
+    auto start = clock::now();
+    auto deadline = start + std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double, std::milli>(remaining()));
+    // Always run one task so that loading progresses even when the budget is spent.
+    while (asyncSystem.dispatchOneMainThreadTask())
+    {
+        if (clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+    charge(clock::now() - start);
+}
+
+void MainThreadScheduler::charge(clock::duration duration)
+{
+    _spent += std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double MainThreadScheduler::remaining() const
+{
+    return std::max(0.0, _budget - _spent);
+}
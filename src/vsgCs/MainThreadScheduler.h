@@ -0,0 +1,110 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace vsgCs
+{
+    /**
+     * @brief How much main thread time per frame goes to tile work.
+     */
+    struct FrameBudgetOptions
+    {
+        // Milliseconds per frame for main thread tile work, when there is no target frame rate
+        double budget = 5.0;
+        // If not 0, the budget adapts so that frames take no longer than 1 / targetFrameRate.
+        double targetFrameRate = 0.0;
+        // Milliseconds that the adaptive budget never goes below
+        double minimumBudget = 0.5;
+        // Largest share of the frame period that the adaptive budget may take
+        double maximumShare = 0.5;
+        // Milliseconds per frame that Cesium's tile cache unloading gets even when the budget is
+        // spent, so that memory is released under a sustained load
+        double minimumUnloadTime = 1.0;
+    };
+
+    /**
+     * @brief Spreads the main thread work of tile loading across frames.
+     *
+     * Tiles that arrive from the worker threads are finished in the main thread: VSG objects are
+     * created, raster overlays are attached, and small objects are compiled. A burst of arriving
+     * tiles can make this take longer than a frame. The scheduler runs the AsyncSystem's main
+     * thread tasks one at a time until the frame's budget is spent, leaving the rest for the next
+     * frames; what is left of the budget is given to Cesium's own main thread loading and
+     * unloading, with a minimum for unloading. At least one task runs each frame, so loading always
+     * makes progress.
+     *
+     * With a target frame rate, the scheduler measures the frame time and adapts the budget: it is
+     * cut when frames are late and grows slowly while they are on time.
+     */
+    class VSGCS_EXPORT MainThreadScheduler
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        void setOptions(const FrameBudgetOptions& options);
+        const FrameBudgetOptions& getOptions() const
+        {
+            return _options;
+        }
+        /**
+         * @brief Start the accounting for a frame. Every tileset calls this; only the first call
+         * of a frame has an effect.
+         */
+        void beginFrame(uint64_t frameCount, clock::time_point frameTime);
+        /**
+         * @brief Run the AsyncSystem's main thread tasks until the frame's budget is spent.
+         */
+        void dispatch();
+        /**
+         * @brief Count main thread tile work done outside of dispatch() against the budget.
+         */
+        void charge(clock::duration duration);
+        // Milliseconds left in this frame's budget
+        double remaining() const;
+        // Milliseconds of main thread work allowed in this frame
+        double getBudget() const
+        {
+            return _budget;
+        }
+    private:
+        FrameBudgetOptions _options;
+        double _budget = 5.0;
+        // Milliseconds spent this frame
+        double _spent = 0.0;
+        std::optional<uint64_t> _frameCount;
+        std::optional<clock::time_point> _lastFrameTime;
+        // Smoothed frame time, in milliseconds
+        double _frameTime = 0.0;
+    };
+
+    MainThreadScheduler& VSGCS_EXPORT getMainThreadScheduler();
+}
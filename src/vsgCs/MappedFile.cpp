@@ -0,0 +1,168 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "MappedFile.h"
+
+#include <curl/curl.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace vsgCs;
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Can't open " + path);
+    }
+    std::shared_ptr<MappedFile> result(new MappedFile);
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Can't get the size of " + path);
+    }
+    result->_size = static_cast<size_t>(fileSize.QuadPart);
+    if (result->_size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+        {
+            result->_mapping = mapping;
+            result->_addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!result->_addr)
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Can't map " + path);
+        }
+    }
+    // The mapping keeps the file open.
+    CloseHandle(file);
+    return result;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_addr)
+    {
+        UnmapViewOfFile(_addr);
+    }
+    if (_mapping)
+    {
+        CloseHandle(_mapping);
+    }
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Can't open " + path + ": " + std::strerror(errno));
+    }
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) != 0)
+    {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("Can't stat " + path + ": " + std::strerror(err));
+    }
+    std::shared_ptr<MappedFile> result(new MappedFile);
+    result->_size = static_cast<size_t>(statBuf.st_size);
+    if (result->_size > 0)
+    {
+        void* addr = mmap(nullptr, result->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            int err = errno;
+            close(fd);
+            throw std::runtime_error("Can't map " + path + ": " + std::strerror(err));
+        }
+        result->_addr = addr;
+        // The whole file is going to be read, usually right away.
+        madvise(addr, result->_size, MADV_WILLNEED);
+    }
+    // The mapping keeps the file open.
+    close(fd);
+    return result;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_addr)
+    {
+        munmap(_addr, _size);
+    }
+}
+
+#endif
+
+std::string vsgCs::getFileUrlPath(const std::string& url)
+{
+    if (url.size() < 5 || strncmp(url.c_str(), "file:", 5) != 0)
+    {
+        return {};
+    }
+    std::string result;
+    CURLU* curlUrl = curl_url();
+    if (curl_url_set(curlUrl, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK)
+    {
+        char* path = nullptr;
+        if (curl_url_get(curlUrl, CURLUPART_PATH, &path, CURLU_URLDECODE) == CURLUE_OK)
+        {
+            result = path;
+            curl_free(path);
+        }
+    }
+    curl_url_cleanup(curlUrl);
+#ifdef _WIN32
+    // file:///C:/foo has the path /C:/foo
+    if (result.size() >= 3 && result[0] == '/' && result[2] == ':')
+    {
+        result.erase(0, 1);
+    }
+#endif
+    return result;
+}
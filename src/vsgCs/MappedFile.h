@@ -0,0 +1,76 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace vsgCs
+{
+    /**
+     * @brief A read-only, memory-mapped file.
+     *
+     * The mapping stays valid for the lifetime of the object, so hold it in a shared_ptr when
+     * handing out the data.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief Map the file at path.
+         *
+         * @throws std::runtime_error if the file can't be opened or mapped.
+         */
+        static std::shared_ptr<MappedFile> open(const std::string& path);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::span<const std::byte> data() const
+        {
+            return {static_cast<const std::byte*>(_addr), _size};
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+    private:
+        MappedFile() = default;
+        void* _addr = nullptr;
+        size_t _size = 0;
+#ifdef _WIN32
+        void* _mapping = nullptr;
+#endif
+    };
+
+    /**
+     * @brief If url is a file: URL, return the local file path that it names; otherwise return
+     * the empty string.
+     */
+    std::string getFileUrlPath(const std::string& url);
+}
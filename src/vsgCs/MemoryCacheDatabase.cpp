@@ -0,0 +1,203 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "MemoryCacheDatabase.h"
+
+#include <algorithm>
+#include <ctime>
+#include <functional>
+
+using namespace vsgCs;
+
+namespace
+{
+    // Rough cost of an entry, including the bookkeeping
+    size_t entrySize(const std::string& key, const CesiumAsync::CacheItem& item)
+    {
+        size_t result = 256 + key.size() + item.cacheRequest.url.size()
+            + item.cacheResponse.data.size();
+        for (const auto& headers : {&item.cacheRequest.headers, &item.cacheResponse.headers})
+        {
+            for (const auto& header : *headers)
+            {
+                result += header.first.size() + header.second.size() + 64;
+            }
+        }
+        return result;
+    }
+}
+
+MemoryCacheDatabase::MemoryCacheDatabase(std::shared_ptr<CesiumAsync::ICacheDatabase> underlying,
+                                         size_t maxBytes,
+                                         std::chrono::seconds timeToLive,
+                                         size_t numShards)
+    : _underlying(std::move(underlying)),
+      _shardBudget(maxBytes / std::max(numShards, size_t(1))),
+      _timeToLive(timeToLive)
+{
+    for (size_t i = 0; i < std::max(numShards, size_t(1)); ++i)
+    {
+        _shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+MemoryCacheDatabase::Shard& MemoryCacheDatabase::getShard(const std::string& key) const
+{
+    return *_shards[std::hash<std::string>{}(key) % _shards.size()];
+}
+
+bool MemoryCacheDatabase::isLive(const Entry& entry) const
+{
+    if (_timeToLive.count() > 0
+        && std::chrono::steady_clock::now() - entry.insertTime > _timeToLive)
+    {
+        return false;
+    }
+    return entry.item.expiryTime > std::time(nullptr);
+}
+
+void MemoryCacheDatabase::eraseLocked(Shard& shard, std::list<Entry>::iterator itr)
+{
+    shard.bytes -= itr->bytes;
+    shard.index.erase(itr->key);
+    shard.lru.erase(itr);
+}
+
+void MemoryCacheDatabase::insert(const std::string& key, CesiumAsync::CacheItem item) const
+{
+    size_t bytes = entrySize(key, item);
+    if (bytes > _shardBudget)
+    {
+        return;
+    }
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto existing = shard.index.find(key);
+    if (existing != shard.index.end())
+    {
+        eraseLocked(shard, existing->second);
+    }
+    while (!shard.lru.empty() && shard.bytes + bytes > _shardBudget)
+    {
+        eraseLocked(shard, std::prev(shard.lru.end()));
+    }
+    shard.lru.push_front(Entry{key, std::move(item), bytes, std::chrono::steady_clock::now()});
+    shard.index.emplace(key, shard.lru.begin());
+    shard.bytes += bytes;
+}
+
+std::optional<CesiumAsync::CacheItem> MemoryCacheDatabase::getEntry(const std::string& key) const
+{
+    {
+        Shard& shard = getShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto itr = shard.index.find(key);
+        if (itr != shard.index.end())
+        {
+            if (isLive(*itr->second))
+            {
+                shard.lru.splice(shard.lru.begin(), shard.lru, itr->second);
+                return itr->second->item;
+            }
+            // Let CachingAssetAccessor revalidate it against the underlying database.
+            eraseLocked(shard, itr->second);
+        }
+    }
+    if (!_underlying)
+    {
+        return std::nullopt;
+    }
+    auto result = _underlying->getEntry(key);
+    if (result)
+    {
+        insert(key, *result);
+    }
+    return result;
+}
+
+bool MemoryCacheDatabase::storeEntry(const std::string& key,
+                                     std::time_t expiryTime,
+                                     const std::string& url,
+                                     const std::string& requestMethod,
+                                     const CesiumAsync::HttpHeaders& requestHeaders,
+                                     uint16_t statusCode,
+                                     const CesiumAsync::HttpHeaders& responseHeaders,
+                                     const std::span<const std::byte>& responseData)
+{
+    bool result = true;
+    if (_underlying)
+    {
+        result = _underlying->storeEntry(key, expiryTime, url, requestMethod, requestHeaders,
+                                         statusCode, responseHeaders, responseData);
+    }
+    insert(key,
+           CesiumAsync::CacheItem(expiryTime,
+                                  CesiumAsync::CacheRequest(requestHeaders, requestMethod, url),
+                                  CesiumAsync::CacheResponse(
+                                      statusCode, responseHeaders,
+                                      std::vector<std::byte>(responseData.begin(),
+                                                             responseData.end()))));
+    return result;
+}
+
+bool MemoryCacheDatabase::prune()
+{
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto itr = shard->lru.begin(); itr != shard->lru.end();)
+        {
+            auto next = std::next(itr);
+            if (!isLive(*itr))
+            {
+                eraseLocked(*shard, itr);
+            }
+            itr = next;
+        }
+    }
+    return _underlying ? _underlying->prune() : true;
+}
+
+bool MemoryCacheDatabase::clearAll()
+{
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+    return _underlying ? _underlying->clearAll() : true;
+}
+
+size_t MemoryCacheDatabase::getSize() const
+{
+    size_t result = 0;
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result += shard->bytes;
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <CesiumAsync/CacheItem.h>
+#include <CesiumAsync/ICacheDatabase.h>
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vsgCs
+{
+    /**
+     * @brief An in-memory LRU cache of responses that can sit in front of another cache database,
+     * e.g. Cesium's SqliteCache.
+     *
+     * Hits are served from RAM without touching the underlying database. New entries are written
+     * through to it. The cache is split into shards, each with its own lock, so that lookups from
+     * different loader threads don't contend.
+     */
+    class VSGCS_EXPORT MemoryCacheDatabase : public CesiumAsync::ICacheDatabase
+    {
+    public:
+        /**
+         * @param underlying the database behind the memory cache; may be null for a memory-only
+         * cache.
+         * @param maxBytes the memory budget, shared evenly among the shards.
+         * @param timeToLive how long an entry may stay in memory; 0 means no limit apart from the
+         * entry's own expiry time.
+         * @param numShards number of independently locked shards.
+         */
+        MemoryCacheDatabase(std::shared_ptr<CesiumAsync::ICacheDatabase> underlying,
+                            size_t maxBytes,
+                            std::chrono::seconds timeToLive = std::chrono::seconds(0),
+                            size_t numShards = 16);
+
+        std::optional<CesiumAsync::CacheItem> getEntry(const std::string& key) const override;
+        bool storeEntry(const std::string& key,
+                        std::time_t expiryTime,
+                        const std::string& url,
+                        const std::string& requestMethod,
+                        const CesiumAsync::HttpHeaders& requestHeaders,
+                        uint16_t statusCode,
+                        const CesiumAsync::HttpHeaders& responseHeaders,
+                        const std::span<const std::byte>& responseData) override;
+        bool prune() override;
+        bool clearAll() override;
+
+        /**
+         * @brief Number of bytes currently held in memory.
+         */
+        size_t getSize() const;
+    private:
+        struct Entry
+        {
+            std::string key;
+            CesiumAsync::CacheItem item;
+            size_t bytes;
+            std::chrono::steady_clock::time_point insertTime;
+        };
+        struct Shard
+        {
+            std::mutex mutex;
+            std::list<Entry> lru;
+            std::unordered_map<std::string, std::list<Entry>::iterator> index;
+            size_t bytes = 0;
+        };
+        Shard& getShard(const std::string& key) const;
+        bool isLive(const Entry& entry) const;
+        void insert(const std::string& key, CesiumAsync::CacheItem item) const;
+        // Called with the shard locked
+        static void eraseLocked(Shard& shard, std::list<Entry>::iterator itr);
+        std::shared_ptr<CesiumAsync::ICacheDatabase> _underlying;
+        size_t _shardBudget;
+        std::chrono::seconds _timeToLive;
+        mutable std::vector<std::unique_ptr<Shard>> _shards;
+    };
+}
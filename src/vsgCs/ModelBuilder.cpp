@@ -1105,6 +1105,13 @@ ModelBuilder::loadMaterial(const CesiumGltf::Material* material, VkPrimitiveTopo
         }
         csMat->descriptorConfig->defines.insert("VSGCS_TILE");
     }
+    // The table is part of the world descriptor set, which WorldNode binds for everything under
+    // it, so it must be in the pipeline layout of every material, tile or not, whether or not
+    // overlays are rendered.
+    if (_genv->features.overlayTextureTable)
+    {
+        csMat->descriptorConfig->defines.insert("VSGCS_OVERLAY_TABLE");
+    }
     vsg::PbrMaterial pbr;
     for (int i = 0; i < 3; ++i)
     {
@@ -1407,6 +1414,10 @@ ModelStateBuilder::loadMaterial(int i, VkPrimitiveTopology topology)
             baseMaterial[topoIndex] = CsMaterial::create();
             baseMaterial[topoIndex]->descriptorConfig = vsg::DescriptorConfigurator::create();
             baseMaterial[topoIndex]->descriptorConfig->shaderSet = genv->shaderFactory->getShaderSet(topology);
+            if (genv->features.overlayTextureTable)
+            {
+                baseMaterial[topoIndex]->descriptorConfig->defines.insert("VSGCS_OVERLAY_TABLE");
+            }
             vsg::PbrMaterial pbr;
             baseMaterial[topoIndex]->descriptorConfig->assignDescriptor("material",
                                                                          vsg::PbrMaterialValue::create(pbr));
@@ -0,0 +1,206 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "NetworkTelemetry.h"
+#include "Tracing.h"
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+using namespace vsgCs;
+
+HostTelemetry::HostTelemetry(const std::string& in_host)
+    : host(in_host),
+      _firstBytePlot("first byte ms " + in_host),
+      _totalPlot("request ms " + in_host)
+{
+}
+
+HostTelemetry& NetworkTelemetry::getOrCreate(const std::string& host)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto itr = _hosts.find(host);
+        if (itr != _hosts.end())
+        {
+            return *itr->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    auto& telemetry = _hosts[host];
+    if (!telemetry)
+    {
+        telemetry = std::make_shared<HostTelemetry>(host);
+    }
+    // Entries are never removed, so the reference stays valid.
+    return *telemetry;
+}
+
+void NetworkTelemetry::record(const std::string& host, const TransferTimes& times)
+{
+    HostTelemetry& telemetry = getOrCreate(host);
+    if (times.connect > 0)
+    {
+        telemetry.dns.record(times.dns);
+        telemetry.connect.record(times.connect);
+        if (times.tls > 0)
+        {
+            telemetry.tls.record(times.tls);
+        }
+    }
+    telemetry.firstByte.record(times.firstByte);
+    telemetry.transfer.record(times.transfer);
+    telemetry.total.record(times.total);
+    telemetry.bytes.record(times.bytes);
+    VSGCS_PLOT(telemetry._firstBytePlot.c_str(), static_cast<double>(times.firstByte) / 1000.0);
+    VSGCS_PLOT(telemetry._totalPlot.c_str(), static_cast<double>(times.total) / 1000.0);
+}
+
+void NetworkTelemetry::recordError(const std::string& host)
+{
+    getOrCreate(host).errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<std::string> NetworkTelemetry::getHosts() const
+{
+    std::vector<std::string> result;
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        result.reserve(_hosts.size());
+        for (const auto& entry : _hosts)
+        {
+            result.push_back(entry.first);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::shared_ptr<const HostTelemetry> NetworkTelemetry::getHost(const std::string& host) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto itr = _hosts.find(host);
+    return itr == _hosts.end() ? nullptr : itr->second;
+}
+
+NetworkTelemetry::Totals NetworkTelemetry::getTotals() const
+{
+    Totals result;
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    for (const auto& entry : _hosts)
+    {
+        const HostTelemetry& telemetry = *entry.second;
+        result.requests += telemetry.total.count();
+        result.errors += telemetry.errors.load(std::memory_order_relaxed);
+        result.bytes += telemetry.bytes.sum();
+        result.firstByte += telemetry.firstByte.sum();
+        result.total += telemetry.total.sum();
+    }
+    return result;
+}
+
+namespace
+{
+    void writeHistogram(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, const char* name,
+                        const Histogram& histogram)
+    {
+        writer.Key(name);
+        writer.StartObject();
+        writer.Key("count");
+        writer.Uint64(histogram.count());
+        writer.Key("mean");
+        writer.Double(histogram.mean());
+        writer.Key("min");
+        writer.Uint64(histogram.min());
+        writer.Key("p50");
+        writer.Uint64(histogram.percentile(0.5));
+        writer.Key("p90");
+        writer.Uint64(histogram.percentile(0.9));
+        writer.Key("p99");
+        writer.Uint64(histogram.percentile(0.99));
+        writer.Key("max");
+        writer.Uint64(histogram.max());
+        // Non-empty buckets as [lower bound, count] pairs
+        writer.Key("buckets");
+        writer.StartArray();
+        for (size_t i = 0; i < Histogram::numBuckets; ++i)
+        {
+            uint64_t count = histogram.bucketCount(i);
+            if (count > 0)
+            {
+                writer.StartArray();
+                writer.Uint64(Histogram::bucketLowerBound(i));
+                writer.Uint64(count);
+                writer.EndArray();
+            }
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+}
+
+std::string NetworkTelemetry::toJson() const
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("units");
+    writer.String("microseconds, bytes");
+    writer.Key("hosts");
+    writer.StartObject();
+    for (const auto& host : getHosts())
+    {
+        auto telemetry = getHost(host);
+        writer.Key(host.c_str());
+        writer.StartObject();
+        writer.Key("errors");
+        writer.Uint64(telemetry->errors.load(std::memory_order_relaxed));
+        writeHistogram(writer, "dns", telemetry->dns);
+        writeHistogram(writer, "connect", telemetry->connect);
+        writeHistogram(writer, "tls", telemetry->tls);
+        writeHistogram(writer, "firstByte", telemetry->firstByte);
+        writeHistogram(writer, "transfer", telemetry->transfer);
+        writeHistogram(writer, "total", telemetry->total);
+        writeHistogram(writer, "bytes", telemetry->bytes);
+        writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+    return buffer.GetString();
+}
+
+bool NetworkTelemetry::writeJson(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        return false;
+    }
+    out << toJson() << "\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,124 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+#include "Histogram.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vsgCs
+{
+    /**
+     * @brief The phases of one network transfer, in microseconds.
+     */
+    struct TransferTimes
+    {
+        uint64_t dns = 0;
+        uint64_t connect = 0;
+        uint64_t tls = 0;
+        // From the request being sent to the first byte of the response
+        uint64_t firstByte = 0;
+        // Receiving the response body
+        uint64_t transfer = 0;
+        uint64_t total = 0;
+        uint64_t bytes = 0;
+    };
+
+    /**
+     * @brief Timing histograms of the requests to one host.
+     *
+     * The connection phases (dns, connect, tls) are only recorded for requests that opened a new
+     * connection.
+     */
+    class VSGCS_EXPORT HostTelemetry
+    {
+    public:
+        explicit HostTelemetry(const std::string& host);
+        const std::string host;
+        Histogram dns;
+        Histogram connect;
+        Histogram tls;
+        Histogram firstByte;
+        Histogram transfer;
+        Histogram total;
+        Histogram bytes;
+        std::atomic<uint64_t> errors{0};
+    private:
+        friend class NetworkTelemetry;
+        // Tracy needs plot names that live as long as the program.
+        const std::string _firstBytePlot;
+        const std::string _totalPlot;
+    };
+
+    /**
+     * @brief Per-host network statistics gathered by UrlAssetAccessor.
+     *
+     * Recording looks the host up under a shared lock, which only contends with the first request
+     * to a new host; the histograms themselves are updated without locks. Statistics can be queried
+     * at any time, plotted in Tracy, and written as JSON.
+     */
+    class VSGCS_EXPORT NetworkTelemetry
+    {
+    public:
+        /**
+         * @brief Running totals over all hosts.
+         */
+        struct Totals
+        {
+            uint64_t requests = 0;
+            uint64_t errors = 0;
+            uint64_t bytes = 0;
+            // Sums of the times of all requests, in microseconds
+            uint64_t firstByte = 0;
+            uint64_t total = 0;
+        };
+
+        void record(const std::string& host, const TransferTimes& times);
+        void recordError(const std::string& host);
+        std::vector<std::string> getHosts() const;
+        /**
+         * @brief The statistics for host, or null if no requests have been made to it.
+         */
+        std::shared_ptr<const HostTelemetry> getHost(const std::string& host) const;
+        Totals getTotals() const;
+        std::string toJson() const;
+        /**
+         * @brief Write toJson() to a file.
+         * @return false if the file can't be written.
+         */
+        bool writeJson(const std::string& path) const;
+    private:
+        HostTelemetry& getOrCreate(const std::string& host);
+        mutable std::shared_mutex _mutex;
+        std::unordered_map<std::string, std::shared_ptr<HostTelemetry>> _hosts;
+    };
+}
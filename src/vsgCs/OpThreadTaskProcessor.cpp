@@ -24,6 +24,9 @@ SOFTWARE.
 
 #include "OpThreadTaskProcessor.h"
 
+#include <algorithm>
+#include <atomic>
+
 namespace vsgCs
 {
     AsyncSystemWrapper& getAsyncSystemWrapper()
@@ -35,10 +38,42 @@ namespace vsgCs
 
 using namespace vsgCs;
 
+namespace
+{
+    std::atomic<uint32_t> wrapperNumThreads{0};
+    std::atomic<uint32_t> wrapperIOThreads{8};
+    std::atomic<uint32_t> wrapperUploadThreads{2};
+    std::atomic<bool> wrapperConstructed{false};
+}
+
 AsyncSystemWrapper::AsyncSystemWrapper()
-    : taskProcessor(std::make_shared<OpThreadTaskProcessor>(4)),
-      asyncSystem(taskProcessor)
+    : taskProcessor(std::make_shared<WorkStealingTaskProcessor>(wrapperNumThreads.load())),
+      asyncSystem(taskProcessor),
+      ioPool(static_cast<int32_t>(std::max(1U, wrapperIOThreads.load()))),
+      uploadPool(static_cast<int32_t>(std::max(1U, wrapperUploadThreads.load())))
+{
+    wrapperConstructed = true;
+}
+
+void AsyncSystemWrapper::setPoolSizes(uint32_t ioThreads, uint32_t uploadThreads)
 {
+    if (wrapperConstructed)
+    {
+        vsg::warn("The thread pool sizes can't be changed after the AsyncSystem is in use.");
+        return;
+    }
+    wrapperIOThreads = ioThreads;
+    wrapperUploadThreads = uploadThreads;
+}
+
+void AsyncSystemWrapper::setNumThreads(uint32_t numThreads)
+{
+    if (wrapperConstructed)
+    {
+        vsg::warn("The number of task threads can't be changed after the AsyncSystem is in use.");
+        return;
+    }
+    wrapperNumThreads = numThreads;
 }
 
 void AsyncSystemWrapper::shutdown()
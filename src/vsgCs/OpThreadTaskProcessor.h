@@ -25,8 +25,10 @@ SOFTWARE.
 #pragma once
 
 #include "vsgCs/Export.h"
+#include "WorkStealingTaskProcessor.h"
 #include <CesiumAsync/ITaskProcessor.h>
 #include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/ThreadPool.h>
 #include <vsg/all.h>
 
 namespace vsgCs
@@ -51,8 +53,20 @@ namespace vsgCs
         AsyncSystemWrapper();
         CesiumAsync::AsyncSystem& getAsyncSystem() noexcept;
         void shutdown();
-        std::shared_ptr<OpThreadTaskProcessor> taskProcessor;
+        // Set the number of worker threads, 0 for one per core. This only has an effect before
+        // the AsyncSystem is first used.
+        static void setNumThreads(uint32_t numThreads);
+        // Set the sizes of the I/O and GPU upload pools, also before first use.
+        static void setPoolSizes(uint32_t ioThreads, uint32_t uploadThreads);
+        // The worker threads of the AsyncSystem do CPU-bound work: parsing, decoding and building
+        // models.
+        std::shared_ptr<WorkStealingTaskProcessor> taskProcessor;
         CesiumAsync::AsyncSystem asyncSystem;
+        // Threads for work that blocks on the network or disk, so that a stalled server doesn't
+        // starve the CPU-bound work.
+        CesiumAsync::ThreadPool ioPool;
+        // Threads for compiling (uploading) tiles to the GPU.
+        CesiumAsync::ThreadPool uploadPool;
     };
 
     AsyncSystemWrapper& VSGCS_EXPORT getAsyncSystemWrapper();
@@ -60,4 +74,20 @@ namespace vsgCs
     {
         return getAsyncSystemWrapper().asyncSystem;
     }
+
+    /**
+     * @brief The pool for blocking I/O; use with AsyncSystem::runInThreadPool().
+     */
+    inline const CesiumAsync::ThreadPool& getIOThreadPool() noexcept
+    {
+        return getAsyncSystemWrapper().ioPool;
+    }
+
+    /**
+     * @brief The pool for GPU uploads; use with AsyncSystem::runInThreadPool().
+     */
+    inline const CesiumAsync::ThreadPool& getUploadThreadPool() noexcept
+    {
+        return getAsyncSystemWrapper().uploadPool;
+    }
 }
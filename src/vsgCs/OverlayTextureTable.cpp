@@ -0,0 +1,166 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#include "OverlayTextureTable.h"
+#include "pbr.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace vsgCs;
+
+namespace
+{
+    // The binding of overlayTable in pbr::addTileBindings()
+    const uint32_t tableBinding = 1;
+}
+
+OverlayTextureTable::OverlayTextureTable(const GraphicsEnvironment& genv)
+    : _defaultTexture(genv.defaultTexture), _pipelineLayout(genv.overlayPipelineLayout),
+      _images(pbr::overlayTableSize, genv.defaultTexture)
+{
+    // Index 0 always holds the default texture.
+    for (uint32_t i = pbr::overlayTableSize - 1; i > 0; --i)
+    {
+        _freeIndices.push_back(i);
+    }
+    auto descriptorBuilder
+        = vsg::DescriptorConfigurator::create(genv.shaderFactory->getShaderSet(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST));
+    vsg::ImageInfoList blueImage{genv.blueNoiseTexture};
+    descriptorBuilder->assignTexture("blueNoise", blueImage);
+    descriptorBuilder->assignTexture("overlayTable", _images);
+    auto configured = getDescriptorSet(descriptorBuilder, pbr::WORLD_DESCRIPTOR_SET);
+    if (!configured)
+    {
+        throw std::runtime_error("Overlay texture table construction failed.");
+    }
+    _setLayout = configured->setLayout;
+    // Every slot shares the descriptors other than the table.
+    for (const auto& descriptor : configured->descriptors)
+    {
+        if (descriptor->dstBinding != tableBinding)
+        {
+            _descriptors.push_back(descriptor);
+        }
+    }
+    addSlot();
+}
+
+uint32_t OverlayTextureTable::add(const vsg::ref_ptr<vsg::ImageInfo>& image)
+{
+    if (_freeIndices.empty())
+    {
+        if (!_warnedFull)
+        {
+            vsg::warn("Overlay texture table is full; overlays will not be drawn.");
+            _warnedFull = true;
+        }
+        return 0;
+    }
+    uint32_t index = _freeIndices.back();
+    _freeIndices.pop_back();
+    _images[index] = image;
+    ++_version;
+    return index;
+}
+
+void OverlayTextureTable::remove(uint32_t index)
+{
+    if (index == 0 || index >= _images.size())
+    {
+        return;
+    }
+    // The table doesn't need to be written again; the index isn't used until it is reassigned
+    // by add().
+    _images[index] = _defaultTexture;
+    _freeIndices.push_back(index);
+}
+
+void OverlayTextureTable::attach(const vsg::ref_ptr<vsg::StateGroup>& stateGroup)
+{
+    stateGroup->add(_slots[_active].command);
+    _stateGroups.emplace_back(stateGroup);
+}
+
+OverlayTextureTable::Slot& OverlayTextureTable::addSlot()
+{
+    auto images = vsg::DescriptorImage::create(_images, tableBinding, 0,
+                                               VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    vsg::Descriptors descriptors = _descriptors;
+    descriptors.push_back(images);
+    auto descriptorSet = RewritableDescriptorSet::create(_setLayout, descriptors);
+    auto command = vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
+                                                  pbr::WORLD_DESCRIPTOR_SET, descriptorSet);
+    _slots.push_back(Slot{command, descriptorSet, images, _version});
+    return _slots.back();
+}
+
+ModifyRastersResult OverlayTextureTable::update(const FrameProgress& progress)
+{
+    ModifyRastersResult result;
+    if (_slots[_active].version == _version)
+    {
+        return result;
+    }
+    vsg::ref_ptr<vsg::StateCommand> previous = _slots[_active].command;
+    size_t next = _active;
+    // As with the tile descriptor sets, the active slot can be written if it was bound in this
+    // frame.
+    if (_slots[next].activatedFrame != progress.frameCount)
+    {
+        _slots[next].retiredFrame = progress.frameCount;
+        auto itr = std::find_if(_slots.begin(), _slots.end(),
+                                [&](const Slot& slot)
+                                {
+                                    return &slot != &_slots[_active] && progress.isComplete(slot.retiredFrame);
+                                });
+        next = static_cast<size_t>(itr - _slots.begin());
+    }
+    bool newSlot = next == _slots.size();
+    auto& slot = newSlot ? addSlot() : _slots[next];
+    slot.images->imageInfoList = _images;
+    slot.version = _version;
+    slot.activatedFrame = progress.frameCount;
+    if (newSlot)
+    {
+        result.compileObjects.emplace_back(slot.command);
+    }
+    else
+    {
+        result.rewriteObjects.emplace_back(slot.descriptorSet);
+    }
+    _active = next;
+    vsg::ref_ptr<vsg::StateCommand> current = slot.command;
+    std::erase_if(_stateGroups, [](const vsg::observer_ptr<vsg::StateGroup>& observed)
+    {
+        return !vsg::ref_ptr<vsg::StateGroup>(observed);
+    });
+    for (auto& observed : _stateGroups)
+    {
+        vsg::ref_ptr<vsg::StateGroup> stateGroup = observed;
+        std::replace(stateGroup->stateCommands.begin(), stateGroup->stateCommands.end(), previous, current);
+    }
+    return result;
+}
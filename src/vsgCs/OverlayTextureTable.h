@@ -0,0 +1,99 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#pragma once
+
+#include "vsgCs/Export.h"
+#include "CesiumGltfBuilder.h"
+#include "GraphicsEnvironment.h"
+
+#include <vsg/commands/BindDescriptorSet.h>
+#include <vsg/nodes/StateGroup.h>
+#include <vsg/state/DescriptorImage.h>
+
+#include <vector>
+
+namespace vsgCs
+{
+    /**
+     * @brief All the raster overlay images in one texture array, bound with the WORLD_DESCRIPTOR_SET
+     * descriptor set.
+     *
+     * Tiles refer to their overlays by index in the table, so attaching or detaching a raster
+     * only changes the tile's parameter buffer. The table is a fixed size array that is always
+     * fully written; unused entries hold the default texture. Changes are written to a descriptor
+     * set that no frame in flight uses, which is then bound in place of the current one. The
+     * table is only used from the main thread.
+     */
+    class VSGCS_EXPORT OverlayTextureTable : public vsg::Inherit<vsg::Object, OverlayTextureTable>
+    {
+    public:
+        explicit OverlayTextureTable(const GraphicsEnvironment& genv);
+        /**
+         * @brief Add an image to the table.
+         * @return the image's index, or 0 (the default texture) if the table is full.
+         */
+        uint32_t add(const vsg::ref_ptr<vsg::ImageInfo>& image);
+        /**
+         * @brief Release an index returned by add(). The image stays referenced by any descriptor
+         * sets that still contain it.
+         */
+        void remove(uint32_t index);
+        /**
+         * @brief Add the command that binds the table to a state group. The command is replaced
+         * when the table changes.
+         */
+        void attach(const vsg::ref_ptr<vsg::StateGroup>& stateGroup);
+        /**
+         * @brief Bind a descriptor set that holds the current contents of the table.
+         * @return The descriptor set to compile or write, if any.
+         */
+        ModifyRastersResult update(const FrameProgress& progress);
+    protected:
+        struct Slot
+        {
+            vsg::ref_ptr<vsg::BindDescriptorSet> command;
+            vsg::ref_ptr<RewritableDescriptorSet> descriptorSet;
+            vsg::ref_ptr<vsg::DescriptorImage> images;
+            uint64_t version = 0;
+            // The frame in which the slot was bound, and the one in which it was replaced
+            uint64_t activatedFrame = 0;
+            uint64_t retiredFrame = 0;
+        };
+        Slot& addSlot();
+        vsg::ref_ptr<vsg::ImageInfo> _defaultTexture;
+        vsg::ref_ptr<vsg::PipelineLayout> _pipelineLayout;
+        vsg::ref_ptr<vsg::DescriptorSetLayout> _setLayout;
+        vsg::Descriptors _descriptors;
+        vsg::ImageInfoList _images;
+        std::vector<uint32_t> _freeIndices;
+        // Incremented when an image is added
+        uint64_t _version = 0;
+        std::vector<Slot> _slots;
+        size_t _active = 0;
+        std::vector<vsg::observer_ptr<vsg::StateGroup>> _stateGroups;
+        bool _warnedFull = false;
+    };
+}
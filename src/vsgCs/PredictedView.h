@@ -0,0 +1,56 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <vsg/core/Inherit.h>
+#include <vsg/core/Object.h>
+#include <vsg/maths/mat4.h>
+#include <vsg/ui/UIEvent.h>
+
+namespace vsgCs
+{
+    /**
+     * @brief Where a camera is going to be, attached to the camera by a manipulator that knows
+     * its destination, e.g. during an animated transition.
+     *
+     * TilesetNode uses it for predictive prefetching instead of extrapolating the camera's
+     * motion.
+     */
+    class VSGCS_EXPORT PredictedView : public vsg::Inherit<vsg::Object, PredictedView>
+    {
+    public:
+        PredictedView(const vsg::dmat4& in_viewMatrix, vsg::time_point in_arrival)
+            : viewMatrix(in_viewMatrix), arrival(in_arrival)
+        {
+        }
+        // The key of the object in the camera
+        static constexpr const char* objectName = "vsgCsPredictedView";
+        // The view matrix (world to eye) at the destination
+        vsg::dmat4 viewMatrix;
+        vsg::time_point arrival;
+    };
+}
@@ -0,0 +1,551 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "RequestRecording.h"
+#include "MappedFile.h"
+#include "Tracing.h"
+
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+
+#include <vsg/io/Logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace vsgCs
+{
+    class RecordingFile
+    {
+    public:
+        explicit RecordingFile(const std::string& path);
+        void append(const std::string& record)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _out.write(record.data(), static_cast<std::streamsize>(record.size()));
+        }
+    private:
+        std::mutex _mutex;
+        std::ofstream _out;
+    };
+
+    class ReplayArchive
+    {
+    public:
+        struct Entry
+        {
+            uint16_t statusCode;
+            std::string contentType;
+            CesiumAsync::HttpHeaders headers;
+            std::chrono::microseconds elapsed;
+            std::span<const std::byte> data;
+        };
+
+        explicit ReplayArchive(const std::string& path);
+        const Entry* find(const std::string& method, const std::string& url) const
+        {
+            auto itr = _entries.find(method + " " + url);
+            return itr == _entries.end() ? nullptr : &itr->second;
+        }
+        std::shared_ptr<MappedFile> file;
+        std::atomic<uint64_t> misses{0};
+    private:
+        std::unordered_map<std::string, Entry> _entries;
+    };
+
+    // Runs functions after a delay on its own thread.
+    class ReplayTimer
+    {
+    public:
+        ~ReplayTimer();
+        void schedule(std::chrono::microseconds delay, std::function<void()> func);
+        // Run func when a response, sent after latency, has been delivered over a link that
+        // carries one response at a time, so that concurrent responses share the bandwidth.
+        void scheduleTransfer(std::chrono::microseconds latency,
+                              std::chrono::microseconds transferTime,
+                              std::function<void()> func);
+    private:
+        void run();
+        void startThreadLocked();
+        std::mutex _mutex;
+        std::condition_variable _cond;
+        std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> _timers;
+        // When the simulated link finishes delivering the responses scheduled so far
+        std::chrono::steady_clock::time_point _linkFree;
+        std::thread _thread;
+        bool _shutdown = false;
+    };
+}
+
+using namespace vsgCs;
+
+namespace
+{
+    const char archiveMagic[4] = {'V', 'C', 'S', 'R'};
+    const uint32_t archiveVersion = 1;
+
+    class RecordWriter
+    {
+    public:
+        template<typename T>
+        void write(const T& value)
+        {
+            const char* ptr = reinterpret_cast<const char*>(&value);
+            buffer.append(ptr, ptr + sizeof(T));
+        }
+        void write(const std::string& value)
+        {
+            write(static_cast<uint32_t>(value.size()));
+            buffer.append(value);
+        }
+        void write(const CesiumAsync::HttpHeaders& headers)
+        {
+            write(static_cast<uint32_t>(headers.size()));
+            for (const auto& header : headers)
+            {
+                write(header.first);
+                write(header.second);
+            }
+        }
+        std::string buffer;
+    };
+
+    class RecordReader
+    {
+    public:
+        explicit RecordReader(std::span<const std::byte> data)
+            : _data(data)
+        {
+        }
+        template<typename T>
+        T read()
+        {
+            T result;
+            std::memcpy(&result, take(sizeof(T)), sizeof(T));
+            return result;
+        }
+        std::string readString()
+        {
+            auto size = read<uint32_t>();
+            const auto* ptr = reinterpret_cast<const char*>(take(size));
+            return {ptr, ptr + size};
+        }
+        CesiumAsync::HttpHeaders readHeaders()
+        {
+            CesiumAsync::HttpHeaders result;
+            auto count = read<uint32_t>();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                std::string name = readString();
+                result.emplace(std::move(name), readString());
+            }
+            return result;
+        }
+        std::span<const std::byte> readData(uint64_t size)
+        {
+            return {take(size), size};
+        }
+        bool atEnd() const
+        {
+            return _pos == _data.size();
+        }
+    private:
+        const std::byte* take(uint64_t size)
+        {
+            if (size > _data.size() - _pos)
+            {
+                throw std::runtime_error("truncated request archive");
+            }
+            const std::byte* result = _data.data() + _pos;
+            _pos += size;
+            return result;
+        }
+        std::span<const std::byte> _data;
+        uint64_t _pos = 0;
+    };
+
+    class ReplayResponse : public CesiumAsync::IAssetResponse
+    {
+    public:
+        // A null entry is a 404 response.
+        ReplayResponse(std::shared_ptr<ReplayArchive> archive, const ReplayArchive::Entry* entry)
+            : _archive(std::move(archive)), _entry(entry)
+        {
+        }
+
+        uint16_t statusCode() const override
+        {
+            return _entry ? _entry->statusCode : 404;
+        }
+
+        std::string contentType() const override
+        {
+            return _entry ? _entry->contentType : std::string();
+        }
+
+        const CesiumAsync::HttpHeaders& headers() const override
+        {
+            static const CesiumAsync::HttpHeaders noHeaders;
+            return _entry ? _entry->headers : noHeaders;
+        }
+
+        std::span<const std::byte> data() const override
+        {
+            return _entry ? _entry->data : std::span<const std::byte>();
+        }
+    private:
+        std::shared_ptr<ReplayArchive> _archive;
+        const ReplayArchive::Entry* _entry;
+    };
+
+    class ReplayRequest : public CesiumAsync::IAssetRequest
+    {
+    public:
+        ReplayRequest(std::string method, std::string url,
+                      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                      std::unique_ptr<ReplayResponse> response)
+            : _method(std::move(method)), _url(std::move(url)), _response(std::move(response))
+        {
+            _headers.insert(headers.begin(), headers.end());
+        }
+
+        const std::string& method() const override
+        {
+            return _method;
+        }
+
+        const std::string& url() const override
+        {
+            return _url;
+        }
+
+        const CesiumAsync::HttpHeaders& headers() const override
+        {
+            return _headers;
+        }
+
+        const CesiumAsync::IAssetResponse* response() const override
+        {
+            return _response.get();
+        }
+    private:
+        std::string _method;
+        std::string _url;
+        CesiumAsync::HttpHeaders _headers;
+        std::unique_ptr<ReplayResponse> _response;
+    };
+
+    // Credentials aren't written to the archive, which may be shared.
+    CesiumAsync::HttpHeaders redactHeaders(const CesiumAsync::HttpHeaders& headers)
+    {
+        static const char* const credentialHeaders[] = {
+            "Authorization", "Proxy-Authorization", "Cookie", "Set-Cookie", "X-Api-Key"
+        };
+        CesiumAsync::HttpHeaders result(headers);
+        for (const char* name : credentialHeaders)
+        {
+            // HttpHeaders compares names without regard to case.
+            auto itr = result.find(name);
+            if (itr != result.end())
+            {
+                itr->second = "[redacted]";
+            }
+        }
+        return result;
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+    record(const std::shared_ptr<RecordingFile>& file,
+           CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>&& future,
+           std::chrono::steady_clock::time_point start)
+    {
+        return std::move(future).thenImmediately(
+            [file, start](std::shared_ptr<CesiumAsync::IAssetRequest>&& request)
+            {
+                const auto* response = request->response();
+                if (response)
+                {
+                    VSGCS_ZONESCOPEDN("record request");
+                    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start);
+                    RecordWriter writer;
+                    writer.write(request->method());
+                    writer.write(request->url());
+                    writer.write(redactHeaders(request->headers()));
+                    writer.write(response->statusCode());
+                    writer.write(response->contentType());
+                    writer.write(redactHeaders(response->headers()));
+                    writer.write(static_cast<int64_t>(elapsed.count()));
+                    auto data = response->data();
+                    writer.write(static_cast<uint64_t>(data.size()));
+                    writer.buffer.append(reinterpret_cast<const char*>(data.data()), data.size());
+                    file->append(writer.buffer);
+                }
+                return std::move(request);
+            });
+    }
+}
+
+RecordingFile::RecordingFile(const std::string& path)
+    : _out(path, std::ios::binary | std::ios::trunc)
+{
+    if (!_out)
+    {
+        throw std::runtime_error("Can't create request archive " + path);
+    }
+    _out.write(archiveMagic, sizeof(archiveMagic));
+    _out.write(reinterpret_cast<const char*>(&archiveVersion), sizeof(archiveVersion));
+}
+
+RecordingAssetAccessor::RecordingAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> accessor,
+                                               const std::string& archivePath)
+    : _accessor(std::move(accessor)), _file(std::make_shared<RecordingFile>(archivePath))
+{
+}
+
+RecordingAssetAccessor::~RecordingAssetAccessor() = default;
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+RecordingAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem,
+                            const std::string& url,
+                            const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+{
+    auto start = std::chrono::steady_clock::now();
+    return record(_file, _accessor->get(asyncSystem, url, headers), start);
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+RecordingAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem,
+                                const std::string& verb,
+                                const std::string& url,
+                                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                                const std::span<const std::byte>& contentPayload)
+{
+    auto start = std::chrono::steady_clock::now();
+    return record(_file, _accessor->request(asyncSystem, verb, url, headers, contentPayload), start);
+}
+
+void RecordingAssetAccessor::tick() noexcept
+{
+    _accessor->tick();
+}
+
+ReplayArchive::ReplayArchive(const std::string& path)
+    : file(MappedFile::open(path))
+{
+    RecordReader reader(file->data());
+    char magic[sizeof(archiveMagic)];
+    for (auto& c : magic)
+    {
+        c = reader.read<char>();
+    }
+    if (std::memcmp(magic, archiveMagic, sizeof(magic)) != 0 || reader.read<uint32_t>() != archiveVersion)
+    {
+        throw std::runtime_error(path + " is not a request archive");
+    }
+    try
+    {
+        while (!reader.atEnd())
+        {
+            std::string method = reader.readString();
+            std::string url = reader.readString();
+            reader.readHeaders();
+            Entry entry;
+            entry.statusCode = reader.read<uint16_t>();
+            entry.contentType = reader.readString();
+            entry.headers = reader.readHeaders();
+            entry.elapsed = std::chrono::microseconds(reader.read<int64_t>());
+            entry.data = reader.readData(reader.read<uint64_t>());
+            // A later recording of the same request replaces an earlier one.
+            _entries.insert_or_assign(method + " " + url, std::move(entry));
+        }
+    }
+    catch (const std::runtime_error&)
+    {
+        // The recording was interrupted while writing the last record.
+        vsg::warn("ReplayAssetAccessor: ", path, " is truncated; using ", _entries.size(), " requests");
+    }
+}
+
+ReplayTimer::~ReplayTimer()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _shutdown = true;
+    }
+    _cond.notify_one();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+void ReplayTimer::startThreadLocked()
+{
+    if (!_thread.joinable())
+    {
+        _thread = std::thread([this]() { run(); });
+    }
+}
+
+void ReplayTimer::schedule(std::chrono::microseconds delay, std::function<void()> func)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        startThreadLocked();
+        _timers.emplace(std::chrono::steady_clock::now() + delay, std::move(func));
+    }
+    _cond.notify_one();
+}
+
+void ReplayTimer::scheduleTransfer(std::chrono::microseconds latency,
+                                   std::chrono::microseconds transferTime,
+                                   std::function<void()> func)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        startThreadLocked();
+        // The first byte arrives after the latency, but not before the link has delivered the
+        // responses ahead of this one.
+        auto start = std::max(std::chrono::steady_clock::now() + latency, _linkFree);
+        _linkFree = start + transferTime;
+        _timers.emplace(_linkFree, std::move(func));
+    }
+    _cond.notify_one();
+}
+
+void ReplayTimer::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        if (_timers.empty())
+        {
+            if (_shutdown)
+            {
+                return;
+            }
+            _cond.wait(lock);
+            continue;
+        }
+        auto first = _timers.begin();
+        // Pending responses are delivered immediately on shutdown.
+        if (!_shutdown && first->first > std::chrono::steady_clock::now())
+        {
+            _cond.wait_until(lock, first->first);
+            continue;
+        }
+        auto func = std::move(first->second);
+        _timers.erase(first);
+        lock.unlock();
+        func();
+        lock.lock();
+    }
+}
+
+ReplayAssetAccessor::ReplayAssetAccessor(const std::string& archivePath, const ReplayOptions& options)
+    : _archive(std::make_shared<ReplayArchive>(archivePath)),
+      _timer(std::make_unique<ReplayTimer>()),
+      _options(options)
+{
+}
+
+ReplayAssetAccessor::~ReplayAssetAccessor() = default;
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+ReplayAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem,
+                         const std::string& url,
+                         const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+{
+    return request(asyncSystem, "GET", url, headers, {});
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+ReplayAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem,
+                             const std::string& verb,
+                             const std::string& url,
+                             const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                             const std::span<const std::byte>&)
+{
+    const auto* entry = _archive->find(verb, url);
+    if (!entry)
+    {
+        ++_archive->misses;
+        vsg::warn("ReplayAssetAccessor: ", verb, " ", url, " is not in the archive");
+    }
+    std::shared_ptr<CesiumAsync::IAssetRequest> result
+        = std::make_shared<ReplayRequest>(verb, url, headers,
+                                          std::make_unique<ReplayResponse>(_archive, entry));
+    std::chrono::microseconds delay(0);
+    std::chrono::microseconds transferTime(0);
+    if (entry && _options.useRecordedTiming)
+    {
+        delay = entry->elapsed;
+    }
+    else if (!_options.useRecordedTiming)
+    {
+        delay = _options.latency;
+        if (entry && _options.bandwidth > 0)
+        {
+            transferTime = std::chrono::microseconds(entry->data.size() * 1000000 / _options.bandwidth);
+        }
+    }
+    if (delay.count() <= 0 && transferTime.count() <= 0)
+    {
+        return asyncSystem.createResolvedFuture(std::move(result));
+    }
+    auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+    auto resolve = [promise, result]()
+    {
+        promise.resolve(result);
+    };
+    if (transferTime.count() > 0)
+    {
+        _timer->scheduleTransfer(delay, transferTime, std::move(resolve));
+    }
+    else
+    {
+        _timer->schedule(delay, std::move(resolve));
+    }
+    return promise.getFuture();
+}
+
+void ReplayAssetAccessor::tick() noexcept
+{
+}
+
+uint64_t ReplayAssetAccessor::getMisses() const
+{
+    return _archive->misses;
+}
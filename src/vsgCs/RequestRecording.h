@@ -0,0 +1,135 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <CesiumAsync/IAssetAccessor.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vsgCs
+{
+    class RecordingFile;
+    class ReplayArchive;
+    class ReplayTimer;
+
+    /**
+     * @brief An asset accessor that records every request made through it, and its response, in
+     * an archive file.
+     *
+     * Each completed request is appended to the archive with its method, URL, request and response
+     * headers, status, the time it took, and the response body. The values of credential headers
+     * like Authorization and Cookie are redacted. ReplayAssetAccessor serves the
+     * archive without a network, which makes runs of an application repeatable.
+     */
+    class VSGCS_EXPORT RecordingAssetAccessor : public CesiumAsync::IAssetAccessor
+    {
+    public:
+        /**
+         * @throws std::runtime_error if the archive can't be created.
+         */
+        RecordingAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> accessor,
+                               const std::string& archivePath);
+        ~RecordingAssetAccessor() override;
+
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            get(const CesiumAsync::AsyncSystem& asyncSystem,
+                const std::string& url,
+                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+            override;
+
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            request(
+                const CesiumAsync::AsyncSystem& asyncSystem,
+                const std::string& verb,
+                const std::string& url,
+                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                const std::span<const std::byte>& contentPayload) override;
+
+        void tick() noexcept override;
+    private:
+        std::shared_ptr<CesiumAsync::IAssetAccessor> _accessor;
+        std::shared_ptr<RecordingFile> _file;
+    };
+
+    struct ReplayOptions
+    {
+        // Delay every response by the time it took when it was recorded; otherwise use latency
+        // and bandwidth.
+        bool useRecordedTiming = false;
+        std::chrono::milliseconds latency{0};
+        // Simulated bandwidth in bytes per second of the link shared by all requests; 0 is
+        // unlimited.
+        uint64_t bandwidth = 0;
+    };
+
+    /**
+     * @brief An asset accessor that serves requests from an archive written by
+     * RecordingAssetAccessor.
+     *
+     * The archive is mapped and indexed by method and URL when the accessor is created, and
+     * response bodies are served without copying. Requests that aren't in the archive get a 404
+     * response. Responses can be delayed to simulate the latency and bandwidth of a network.
+     */
+    class VSGCS_EXPORT ReplayAssetAccessor : public CesiumAsync::IAssetAccessor
+    {
+    public:
+        /**
+         * @throws std::runtime_error if the archive can't be read.
+         */
+        explicit ReplayAssetAccessor(const std::string& archivePath,
+                                     const ReplayOptions& options = ReplayOptions());
+        ~ReplayAssetAccessor() override;
+
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            get(const CesiumAsync::AsyncSystem& asyncSystem,
+                const std::string& url,
+                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+            override;
+
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            request(
+                const CesiumAsync::AsyncSystem& asyncSystem,
+                const std::string& verb,
+                const std::string& url,
+                const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+                const std::span<const std::byte>& contentPayload) override;
+
+        void tick() noexcept override;
+
+        /**
+         * @brief Number of requests that weren't found in the archive.
+         */
+        uint64_t getMisses() const;
+    private:
+        std::shared_ptr<ReplayArchive> _archive;
+        std::unique_ptr<ReplayTimer> _timer;
+        ReplayOptions _options;
+    };
+}
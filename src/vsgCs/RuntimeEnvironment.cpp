@@ -24,8 +24,15 @@ SOFTWARE.
 
 #include "RuntimeEnvironment.h"
 
+#include "ArchiveAssetAccessor.h"
+#include "FileCacheDatabase.h"
+#include "MainThreadScheduler.h"
+#include "MemoryCacheDatabase.h"
 #include "OpThreadTaskProcessor.h"
+#include "RequestRecording.h"
 #include "Tracing.h"
+#include "UrlAssetAccessor.h"
+#include "pbr.h"
 #include "vsgResourcePreparer.h"
 
 #include "vsgCs/Config.h"
@@ -167,8 +174,35 @@ void RuntimeEnvironment::initializeCs(vsg::CommandLine& arguments)
     {
         _csCacheFile = csCacheFile;
     }
+    auto csFileCacheDir = arguments.value(std::string(), "--cesium-file-cache");
+    if (!csFileCacheDir.empty())
+    {
+        _csFileCacheDir = csFileCacheDir;
+    }
+    arguments.read("--cesium-file-cache-size", _csFileCacheSize);
+    arguments.read("--memory-cache-size", _memoryCacheSize);
+    arguments.read("--memory-cache-ttl", _memoryCacheTtl);
+    auto recordFile = arguments.value(std::string(), "--record-requests");
+    if (!recordFile.empty())
+    {
+        _recordFile = recordFile;
+    }
+    auto replayFile = arguments.value(std::string(), "--replay-requests");
+    if (!replayFile.empty())
+    {
+        _replayFile = replayFile;
+    }
+    arguments.read("--replay-latency", _replayLatency);
+    arguments.read("--replay-bandwidth", _replayBandwidth);
+    _replayRecordedTiming = arguments.read("--replay-recorded-timing");
+    auto telemetryFile = arguments.value(std::string(), "--network-telemetry");
+    if (!telemetryFile.empty())
+    {
+        _telemetryFile = telemetryFile;
+    }
     generateShaderDebugInfo = arguments.read("--shader-debug-info");
     enableLodTransitionPeriod = arguments.read("--lod-transition");
+    overlayTextureTable = arguments.read("--overlay-texture-table");
 
     bool tracyDefault = false;
 #ifdef TRACY_ENABLE
@@ -192,6 +226,40 @@ void RuntimeEnvironment::initializeCs(vsg::CommandLine& arguments)
     }
 #endif
     enableProjNetwork = readBooleanArgument(arguments, "proj-network", true);
+    useCurlMulti = readBooleanArgument(arguments, "curl-multi", false);
+    arguments.read("--stale-request-generations", _staleRequestGenerations);
+    if (arguments.read("--adaptive-concurrency"))
+    {
+        setAdaptiveConcurrency(AdaptiveConcurrencyOptions());
+    }
+    prefetch = readBooleanArgument(arguments, "prefetch", false);
+    printTaskStatistics = arguments.read("--task-stats");
+    uint32_t taskThreads = 0;
+    if (arguments.read("--task-threads", taskThreads))
+    {
+        AsyncSystemWrapper::setNumThreads(taskThreads);
+    }
+    uint32_t ioThreads = 8;
+    uint32_t uploadThreads = 2;
+    bool poolSizesGiven = arguments.read("--io-threads", ioThreads);
+    poolSizesGiven = arguments.read("--upload-threads", uploadThreads) || poolSizesGiven;
+    if (poolSizesGiven)
+    {
+        AsyncSystemWrapper::setPoolSizes(ioThreads, uploadThreads);
+    }
+    double uploadBatchWindow = _uploadBatchOptions.window.count();
+    if (arguments.read("--upload-batch-window", uploadBatchWindow))
+    {
+        _uploadBatchOptions.window = std::chrono::duration<double, std::milli>(uploadBatchWindow);
+    }
+    arguments.read("--upload-batch-size", _uploadBatchOptions.maxObjects);
+    FrameBudgetOptions frameBudget;
+    bool frameBudgetGiven = arguments.read("--frame-budget", frameBudget.budget);
+    frameBudgetGiven = arguments.read("--target-frame-rate", frameBudget.targetFrameRate) || frameBudgetGiven;
+    if (frameBudgetGiven)
+    {
+        getMainThreadScheduler().setOptions(frameBudget);
+    }
 }
 
 void RuntimeEnvironment::initialize(vsg::CommandLine &arguments,
@@ -334,6 +402,27 @@ DeviceFeatures RuntimeEnvironment::prepareFeaturesAndExtensions(const vsg::ref_p
         features.wideLines = true;
         traits->deviceFeatures->get().wideLines = 1;
     }
+    // Overlay texture table: the table is indexed with a value from the tile parameters, and all
+    // its samplers count against the per-stage limit.
+    if (overlayTextureTable)
+    {
+        const auto& limits = physDevice->getProperties().limits;
+        // Leave room for the primitive textures, shadow maps, and blue noise.
+        const uint32_t samplersNeeded = pbr::overlayTableSize + pbr::maxOverlays + 16;
+        if (physFeatures.shaderSampledImageArrayDynamicIndexing
+            && limits.maxPerStageDescriptorSamplers >= samplersNeeded
+            && limits.maxPerStageDescriptorSampledImages >= samplersNeeded
+            && limits.maxDescriptorSetSamplers >= samplersNeeded
+            && limits.maxDescriptorSetSampledImages >= samplersNeeded)
+        {
+            features.overlayTextureTable = true;
+            traits->deviceFeatures->get().shaderSampledImageArrayDynamicIndexing = 1;
+        }
+        else
+        {
+            vsg::warn("The device doesn't support the overlay texture table; using per-tile overlay textures.");
+        }
+    }
 #ifdef TRACY_ENABLE
     for (VkExtensionProperties extension : extensionProperties)
     {
@@ -404,6 +493,20 @@ void RuntimeEnvironment::setViewer(const vsg::ref_ptr<vsg::Viewer>& viewer)
         throw std::logic_error("No resource preparer!");
     }
     resourcePrep->viewer = viewer;
+    if (!viewer)
+    {
+        return;
+    }
+    if (auto current = _updateOperation.cast<UpdateResourcePreparer>())
+    {
+        vsg::ref_ptr<vsg::Viewer> currentViewer = current->viewer;
+        if (currentViewer == viewer && current->preparer.lock() == resourcePrep)
+        {
+            return;
+        }
+    }
+    _updateOperation = UpdateResourcePreparer::create(resourcePrep, viewer);
+    viewer->addUpdateOperation(_updateOperation, vsg::UpdateOperations::ALL_FRAMES);
 }
 
 vsg::ref_ptr<vsg::Viewer> RuntimeEnvironment::getViewer()
@@ -414,35 +517,97 @@ vsg::ref_ptr<vsg::Viewer> RuntimeEnvironment::getViewer()
     return viewer;
 }
 
-std::shared_ptr<Cesium3DTilesSelection::TilesetExternals> RuntimeEnvironment::getTilesetExternals()
+std::shared_ptr<CesiumAsync::IAssetAccessor> RuntimeEnvironment::makeAssetAccessor()
 {
-    if (_externals)
+    auto logger = spdlog::default_logger();
+    if (_replayFile.has_value())
+    {
+        ReplayOptions replayOptions;
+        replayOptions.useRecordedTiming = _replayRecordedTiming;
+        replayOptions.latency = std::chrono::milliseconds(_replayLatency);
+        // Mbit/s to bytes per second
+        replayOptions.bandwidth = static_cast<uint64_t>(_replayBandwidth * 1000000.0 / 8.0);
+        auto replayAccessor = std::make_shared<ReplayAssetAccessor>(_replayFile.value(), replayOptions);
+        return std::make_shared<ArchiveAssetAccessor>(replayAccessor);
+    }
+    std::shared_ptr<CesiumAsync::IAssetAccessor> urlAccessor;
+    // Telemetry is gathered by vsgCs' accessor, also in blocking mode.
+    if (useCurlMulti || collectNetworkTelemetry || _telemetryFile.has_value())
+    {
+        UrlAssetAccessorOptions accessorOptions;
+        accessorOptions.doGlobalCurlInit = false;
+        accessorOptions.useCurlMulti = useCurlMulti;
+        accessorOptions.telemetryFile = _telemetryFile.value_or(std::string());
+        accessorOptions.defaultHostConcurrencyLimit = _defaultHostConcurrencyLimit;
+        accessorOptions.hostConcurrencyLimits = _hostConcurrencyLimits;
+        accessorOptions.staleRequestGenerations = _staleRequestGenerations;
+        accessorOptions.adaptiveConcurrency = _adaptiveConcurrency;
+        _urlAssetAccessor = std::make_shared<UrlAssetAccessor>(accessorOptions);
+        urlAccessor = _urlAssetAccessor;
+    }
+    else
     {
-        return _externals;
+        CesiumCurl::CurlAssetAccessorOptions accessorOptions;
+        accessorOptions.requestHeaders.emplace_back("X-Cesium-Client", "vsgCs");
+        accessorOptions.requestHeaders.emplace_back("X-Cesium-Client-Version", Version::get());
+        accessorOptions.requestHeaders.emplace_back("X-Cesium-Client-Engine", Version::getEngineVersion());
+        accessorOptions.requestHeaders.emplace_back("X-Cesium-Client-OS",
+                                                     Version::getOsVersion());
+        accessorOptions.doGlobalInit = false;
+        urlAccessor = std::make_shared<CesiumCurl::CurlAssetAccessor>(accessorOptions);
+    }
+    std::shared_ptr<CesiumAsync::ICacheDatabase> cacheDatabase;
+    if (_csFileCacheDir.has_value())
+    {
+        if (_csCacheFile.has_value())
+        {
+            vsg::warn("Both --cesium-cache and --cesium-file-cache given; using the file cache.");
+        }
+        cacheDatabase = std::make_shared<FileCacheDatabase>(_csFileCacheDir.value(),
+                                                            _csFileCacheSize * 1024 * 1024);
+    }
+    else if (_csCacheFile.has_value())
+    {
+        cacheDatabase = std::make_shared<CesiumAsync::SqliteCache>(logger, _csCacheFile.value());
+    }
+    if (_memoryCacheSize > 0)
+    {
+        cacheDatabase = std::make_shared<MemoryCacheDatabase>(cacheDatabase,
+                                                              _memoryCacheSize * 1024 * 1024,
+                                                              std::chrono::seconds(_memoryCacheTtl));
     }
-    auto logger = spdlog::default_logger();
-    CesiumCurl::CurlAssetAccessorOptions accessorOptions;
-    accessorOptions.requestHeaders.emplace_back("X-Cesium-Client", "vsgCs");
-    accessorOptions.requestHeaders.emplace_back("X-Cesium-Client-Version", Version::get());
-    accessorOptions.requestHeaders.emplace_back("X-Cesium-Client-Engine", Version::getEngineVersion());
-    accessorOptions.requestHeaders.emplace_back("X-Cesium-Client-OS",
-                                                 Version::getOsVersion());
-    accessorOptions.doGlobalInit = false;
-    auto urlAccessor = std::make_shared<CesiumCurl::CurlAssetAccessor>(accessorOptions);
     std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor;
-    if (_csCacheFile.has_value())
+    if (cacheDatabase)
     {
         assetAccessor = std::make_shared<CesiumAsync::CachingAssetAccessor>(
             logger,
             urlAccessor,
-            std::make_shared<CesiumAsync::SqliteCache>(logger, _csCacheFile.value()));
+            cacheDatabase);
     }
     else
     {
         assetAccessor = urlAccessor;
     }
+    // Record what the tilesets see, including responses that come from the caches.
+    if (_recordFile.has_value())
+    {
+        assetAccessor = std::make_shared<RecordingAssetAccessor>(assetAccessor, _recordFile.value());
+    }
+    // Archive entries are local files; don't copy them into the cache.
+    return std::make_shared<ArchiveAssetAccessor>(assetAccessor);
+}
+
+std::shared_ptr<Cesium3DTilesSelection::TilesetExternals> RuntimeEnvironment::getTilesetExternals()
+{
+    if (_externals)
+    {
+        return _externals;
+    }
+    auto logger = spdlog::default_logger();
+    auto assetAccessor = makeAssetAccessor();
     const CesiumAsync::AsyncSystem& asyncSystem = getAsyncSystem();
     auto resourcePreparer = std::make_shared<vsgResourcePreparer>(genv);
+    resourcePreparer->getUploadBatcher().setOptions(_uploadBatchOptions);
     auto creditSystem = std::make_shared<CesiumUtility::CreditSystem>();
     using TE = Cesium3DTilesSelection::TilesetExternals;
     return _externals
@@ -450,6 +615,57 @@ std::shared_ptr<Cesium3DTilesSelection::TilesetExternals> RuntimeEnvironment::ge
                                   logger, nullptr});
 }
 
+void RuntimeEnvironment::setTilesetExternals(
+    const std::shared_ptr<Cesium3DTilesSelection::TilesetExternals>& externals)
+{
+    _externals = externals;
+}
+
+NetworkTelemetry* RuntimeEnvironment::getNetworkTelemetry()
+{
+    return _urlAssetAccessor ? &_urlAssetAccessor->telemetry : nullptr;
+}
+
+void RuntimeEnvironment::cancelNetworkRequests()
+{
+    if (_urlAssetAccessor)
+    {
+        _urlAssetAccessor->cancelAll();
+    }
+}
+
+void RuntimeEnvironment::setHostConcurrencyLimit(const std::string& host, long limit)
+{
+    _hostConcurrencyLimits[host] = limit;
+    if (_urlAssetAccessor)
+    {
+        _urlAssetAccessor->setHostConcurrencyLimit(host, limit);
+    }
+}
+
+void RuntimeEnvironment::setDefaultHostConcurrencyLimit(long limit)
+{
+    _defaultHostConcurrencyLimit = limit;
+    if (_urlAssetAccessor)
+    {
+        _urlAssetAccessor->hostConcurrency.setDefaultLimit(limit);
+    }
+}
+
+void RuntimeEnvironment::setAdaptiveConcurrency(const AdaptiveConcurrencyOptions& options)
+{
+    _adaptiveConcurrency = options;
+    collectNetworkTelemetry = true;
+    if (_urlAssetAccessor)
+    {
+        _urlAssetAccessor->setAdaptiveConcurrency(options);
+    }
+    else if (_externals)
+    {
+        vsg::warn("Adaptive concurrency must be enabled before tilesets are created.");
+    }
+}
+
 void RuntimeEnvironment::update()
 {
 }
@@ -487,9 +703,32 @@ std::string RuntimeEnvironment::csUsage()
         "--ion-token token_string user's Cesium ion token\n"
         "--ion-token-file filename file containing user's ion token\n"
         "--cesium-cache filename\t cache file for 3D Tiles remote requests\n"
+        "--cesium-file-cache directory cache directory for 3D Tiles remote requests, one file per response\n"
+        "--cesium-file-cache-size MB size limit of --cesium-file-cache (default 4096)\n"
+        "--memory-cache-size MB\t size of in-memory cache for 3D Tiles requests (default 0)\n"
+        "--memory-cache-ttl seconds\t maximum time an entry stays in the memory cache (default 0, no limit)\n"
+        "--record-requests filename record all 3D Tiles requests and responses in an archive\n"
+        "--replay-requests filename serve 3D Tiles requests from a recorded archive, without the network\n"
+        "--replay-latency ms\t added latency of replayed responses (default 0)\n"
+        "--replay-bandwidth Mbit/s simulated bandwidth of replayed responses (default 0, unlimited)\n"
+        "--replay-recorded-timing delay replayed responses by their recorded time\n"
+        "--network-telemetry filename write per-host request timings as JSON at exit\n"
         "--shader-debug-info\t generate symbols for shader source debugging\n"
         "--lod-transition\t enable noise-based LOD transition\n"
+        "--overlay-texture-table\t bind all raster overlay images in one texture array\n"
         "--[no-]proj-network\t disable / enable Proj network use (default true)\n"
+        "--[no-]curl-multi\t use vsgCs' curl multi accessor for network requests (default false)\n"
+        "--stale-request-generations n drop curl multi requests still queued after n tileset updates (default 0, never)\n"
+        "--adaptive-concurrency\t adapt the number of simultaneous requests to each host to its throughput and latency\n"
+        "--[no-]prefetch\t load tiles ahead of the moving camera (default false)\n"
+        "--task-threads n\t number of worker threads for tile loading (default 0, one per core)\n"
+        "--io-threads n\t number of threads for blocking network and disk requests (default 8)\n"
+        "--upload-threads n\t number of threads for compiling tiles to the GPU (default 2)\n"
+        "--task-stats\t\t print task queue depth, wait and run times at exit\n"
+        "--upload-batch-window ms time to collect tiles for one GPU upload (default 2)\n"
+        "--upload-batch-size n\t maximum number of tiles and images in one GPU upload (default 32)\n"
+        "--frame-budget ms\t main thread time per frame for tile loading (default 5)\n"
+        "--target-frame-rate Hz\t adapt the main thread tile loading time to this frame rate\n"
     };
 }
 
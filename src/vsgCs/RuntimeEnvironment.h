@@ -25,18 +25,26 @@ SOFTWARE.
 #pragma once
 
 #include "vsgCs/Export.h"
+#include "ConcurrencyController.h"
 #include "GraphicsEnvironment.h"
+#include "UploadBatcher.h"
 #include <Cesium3DTilesSelection/TilesetExternals.h>
+#include <vsg/app/UpdateOperations.h>
 #include <vsg/app/WindowTraits.h>
 #include <vsg/core/Inherit.h>
 #include <vsg/io/Options.h>
 
 #include <openssl/ssl.h>
 
+#include <map>
+#include <optional>
+
 namespace vsgCs
 {
 
     class TracyContextValue;
+    class NetworkTelemetry;
+    class UrlAssetAccessor;
 
     /**
      * Objects that are needed by vsgCs for initializing VSG, Vulkan, Cesium Ion...
@@ -99,7 +107,9 @@ namespace vsgCs
          * @brief Set the viewer object.
          *
          * TilesetNode and WorldNode objects can be created before the VSG viewer, but
-         * RuntimeEnvironment needs the viewer before code can start running.
+         * RuntimeEnvironment needs the viewer before code can start running. This also adds the
+         * update operation that releases the GPU resources of freed tiles; the operation is
+         * added only once for a given viewer and resource preparer.
          */
         void setViewer(const vsg::ref_ptr<vsg::Viewer>& viewer);
         
@@ -108,6 +118,21 @@ namespace vsgCs
          */
         std::shared_ptr<Cesium3DTilesSelection::TilesetExternals> getTilesetExternals();
 
+        /**
+         * Replace the tileset externals, e.g. with a resource preparer that doesn't need a
+         * viewer. Call this before any tilesets are created.
+         */
+        void setTilesetExternals(const std::shared_ptr<Cesium3DTilesSelection::TilesetExternals>& externals);
+
+        /**
+         * Create the asset accessor, including any caches, that is specified by the command line
+         * options. getTilesetExternals() uses this. Files in .3tz and zip archives are read by
+         * an ArchiveAssetAccessor in front of the caches. --record-requests wraps the accessor in a
+         * RecordingAssetAccessor; --replay-requests replaces the network and the caches with a
+         * ReplayAssetAccessor.
+         */
+        std::shared_ptr<CesiumAsync::IAssetAccessor> makeAssetAccessor();
+
         std::shared_ptr<CesiumAsync::IAssetAccessor> getAssetAccessor()
         {
             return getTilesetExternals()->pAssetAccessor;
@@ -115,6 +140,38 @@ namespace vsgCs
 
         vsg::ref_ptr<vsg::Viewer> getViewer();
 
+        /**
+         * @brief Limit the number of simultaneous network requests to a host. 0 removes the limit.
+         *
+         * The limits are enforced by vsgCs' own asset accessor, used with --curl-multi.
+         */
+        void setHostConcurrencyLimit(const std::string& host, long limit);
+        void setDefaultHostConcurrencyLimit(long limit);
+        /**
+         * @brief Adapt the number of simultaneous requests to each host to its measured
+         * throughput and latency, and raise the tile load limits of tilesets built afterwards to
+         * options.maximum so that the host limits govern.
+         *
+         * This uses vsgCs' asset accessor and its telemetry, so it must be called before the
+         * tileset externals are created, e.g. by a world's "network" object or
+         * --adaptive-concurrency.
+         */
+        void setAdaptiveConcurrency(const AdaptiveConcurrencyOptions& options);
+        const std::optional<AdaptiveConcurrencyOptions>& getAdaptiveConcurrency() const
+        {
+            return _adaptiveConcurrency;
+        }
+        /**
+         * @brief Per-host timing statistics of network requests, or null if vsgCs' asset
+         * accessor isn't used (see --curl-multi and --network-telemetry).
+         */
+        NetworkTelemetry* getNetworkTelemetry();
+        /**
+         * @brief Cancel the queued and in-flight network requests of vsgCs' curl multi accessor,
+         * so that destroying the tilesets doesn't wait on the network.
+         */
+        void cancelNetworkRequests();
+
         /**
          * @brief Update the environment for a new frame.
          *
@@ -143,14 +200,43 @@ namespace vsgCs
         std::string ionAccessToken;
         bool generateShaderDebugInfo = false;
         bool enableLodTransitionPeriod = false;
+        // Put all overlay images in one texture table, if the device supports it. Must be set
+        // before the window is opened.
+        bool overlayTextureTable = false;
         vsg::ref_ptr<GraphicsEnvironment> genv;
         vsg::ref_ptr<TracyContextValue> tracyContext;
         bool hasProj;
         bool enableProjNetwork = true;
+        bool useCurlMulti = false;
+        // Use vsgCs' asset accessor, which gathers network telemetry, even without --curl-multi.
+        // Must be set before the tileset externals are created.
+        bool collectNetworkTelemetry = false;
+        // Load tiles ahead of moving cameras in all tilesets; see TilesetNode::setPrefetch().
+        bool prefetch = false;
+        // Print the task statistics (see TaskStatistics.h) in vsgCs::shutdown().
+        bool printTaskStatistics = false;
         static vsg::ref_ptr<RuntimeEnvironment> get();
     protected:
         std::shared_ptr<Cesium3DTilesSelection::TilesetExternals> _externals;
         std::optional<std::string> _csCacheFile;
+        std::optional<std::string> _csFileCacheDir;
+        uint64_t _csFileCacheSize = 4096;
+        size_t _memoryCacheSize = 0;
+        long _memoryCacheTtl = 0;
+        std::optional<std::string> _recordFile;
+        std::optional<std::string> _replayFile;
+        long _replayLatency = 0;
+        double _replayBandwidth = 0.0;
+        bool _replayRecordedTiming = false;
+        std::optional<std::string> _telemetryFile;
+        std::shared_ptr<UrlAssetAccessor> _urlAssetAccessor;
+        std::map<std::string, long> _hostConcurrencyLimits;
+        long _defaultHostConcurrencyLimit = 0;
+        uint64_t _staleRequestGenerations = 0;
+        std::optional<AdaptiveConcurrencyOptions> _adaptiveConcurrency;
+        UploadBatchOptions _uploadBatchOptions;
+        // The update operation added by setViewer()
+        vsg::ref_ptr<vsg::Operation> _updateOperation;
         OPENSSL_INIT_SETTINGS* opensslSettings = nullptr;
     };
 }
@@ -0,0 +1,112 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "TaskStatistics.h"
+#include "Tracing.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace vsgCs
+{
+    TaskStatistics& getTaskStatistics()
+    {
+        static TaskStatistics statistics;
+        return statistics;
+    }
+}
+
+using namespace vsgCs;
+
+namespace
+{
+    const char* categoryNames[] = {"fetch", "parse", "build", "compile", "raster"};
+#ifdef TRACY_ENABLE
+    // Tracy needs names with static storage.
+    const char* queuedPlotNames[] = {"queued fetch tasks", "queued parse tasks", "queued build tasks",
+                                     "queued compile tasks", "queued raster tasks"};
+#endif
+
+    uint64_t microseconds(TaskStatistics::clock::duration duration)
+    {
+        auto count = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return count > 0 ? static_cast<uint64_t>(count) : 0;
+    }
+}
+
+const char* vsgCs::getTaskCategoryName(TaskCategory category)
+{
+    return category < TaskCategory::Count ? categoryNames[static_cast<size_t>(category)] : "unknown";
+}
+
+void TaskStatistics::taskQueued(TaskCategory category)
+{
+    [[maybe_unused]] auto queued = get(category).queued.fetch_add(1, std::memory_order_relaxed) + 1;
+    VSGCS_PLOT(queuedPlotNames[static_cast<size_t>(category)], queued);
+}
+
+void TaskStatistics::taskStarted(TaskCategory category, clock::time_point queueTime,
+                                 clock::time_point now)
+{
+    auto& stats = get(category);
+    [[maybe_unused]] auto queued = stats.queued.fetch_sub(1, std::memory_order_relaxed) - 1;
+    VSGCS_PLOT(queuedPlotNames[static_cast<size_t>(category)], queued);
+    stats.wait.record(microseconds(now - queueTime));
+}
+
+void TaskStatistics::taskFinished(TaskCategory category, clock::time_point startTime,
+                                  clock::time_point now)
+{
+    get(category).run.record(microseconds(now - startTime));
+}
+
+std::string TaskStatistics::toString() const
+{
+    std::ostringstream out;
+    out << "task statistics (microseconds)\n"
+        << std::left << std::setw(9) << "category" << std::right
+        << std::setw(10) << "tasks" << std::setw(8) << "queued"
+        << std::setw(12) << "wait mean" << std::setw(12) << "wait p99"
+        << std::setw(12) << "run mean" << std::setw(12) << "run p99" << "\n";
+    for (size_t i = 0; i < _categories.size(); ++i)
+    {
+        const auto& stats = _categories[i];
+        out << std::left << std::setw(9) << categoryNames[i] << std::right
+            << std::setw(10) << stats.run.count();
+        // Work that runs inside other tasks is never queued on its own.
+        if (stats.wait.count() == 0)
+        {
+            out << std::setw(8) << "-" << std::setw(12) << "-" << std::setw(12) << "-";
+        }
+        else
+        {
+            out << std::setw(8) << stats.queued.load(std::memory_order_relaxed)
+                << std::setw(12) << static_cast<uint64_t>(stats.wait.mean())
+                << std::setw(12) << stats.wait.percentile(0.99);
+        }
+        out << std::setw(12) << static_cast<uint64_t>(stats.run.mean())
+            << std::setw(12) << stats.run.percentile(0.99) << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,141 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+#include "Histogram.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace vsgCs
+{
+    /**
+     * @brief The kinds of work that tile loading does in background threads.
+     */
+    enum class TaskCategory
+    {
+        // Blocking network and file requests, in the I/O pool
+        Fetch,
+        // All tasks of the AsyncSystem's worker threads; mostly Cesium's parsing and decoding of
+        // tile content, but Build and Raster work is done inside them too.
+        Parse,
+        // Building VSG models from glTF
+        Build,
+        // Compiling models to the GPU, in the upload pool
+        Compile,
+        // Decoding and compiling raster overlay images
+        Raster,
+        Count
+    };
+
+    const char* VSGCS_EXPORT getTaskCategoryName(TaskCategory category);
+
+    /**
+     * @brief Queue depth, wait time and run time of tasks, per category.
+     *
+     * Times are in microseconds. Everything is kept in atomic counters and lock-free Histograms,
+     * so recording costs a couple of clock reads per task. Build and Raster work runs inside Parse
+     * tasks and only has run times.
+     */
+    class VSGCS_EXPORT TaskStatistics
+    {
+    public:
+        struct Category
+        {
+            // Tasks waiting to run
+            std::atomic<int64_t> queued{0};
+            Histogram wait;
+            Histogram run;
+        };
+
+        using clock = std::chrono::steady_clock;
+
+        Category& get(TaskCategory category)
+        {
+            return _categories[static_cast<size_t>(category)];
+        }
+        const Category& get(TaskCategory category) const
+        {
+            return _categories[static_cast<size_t>(category)];
+        }
+        void taskQueued(TaskCategory category);
+        // The task queued at queueTime starts running.
+        void taskStarted(TaskCategory category, clock::time_point queueTime, clock::time_point now);
+        void taskFinished(TaskCategory category, clock::time_point startTime, clock::time_point now);
+        /**
+         * @brief A table of the statistics, for printing.
+         */
+        std::string toString() const;
+    private:
+        std::array<Category, static_cast<size_t>(TaskCategory::Count)> _categories;
+    };
+
+    TaskStatistics& VSGCS_EXPORT getTaskStatistics();
+
+    /**
+     * @brief Records the run time of the enclosing scope, for work that is done synchronously
+     * inside another task.
+     */
+    class VSGCS_EXPORT TaskTimer
+    {
+    public:
+        explicit TaskTimer(TaskCategory category)
+            : _category(category), _start(TaskStatistics::clock::now())
+        {
+        }
+        ~TaskTimer()
+        {
+            getTaskStatistics().taskFinished(_category, _start, TaskStatistics::clock::now());
+        }
+        TaskTimer(const TaskTimer&) = delete;
+        TaskTimer& operator=(const TaskTimer&) = delete;
+    private:
+        TaskCategory _category;
+        TaskStatistics::clock::time_point _start;
+    };
+
+    /**
+     * @brief Wrap a function that is about to be queued in a thread pool so that its queueing,
+     * wait and run time are recorded.
+     */
+    template<typename F>
+    auto instrumentTask(TaskCategory category, F&& f)
+    {
+        getTaskStatistics().taskQueued(category);
+        return [category, queueTime = TaskStatistics::clock::now(), f = std::forward<F>(f)]() mutable
+        {
+            auto& statistics = getTaskStatistics();
+            auto start = TaskStatistics::clock::now();
+            statistics.taskStarted(category, queueTime, start);
+            TaskTimer timer(category);
+            return f();
+        };
+    }
+}
@@ -0,0 +1,253 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#include "TileParameterBuffer.h"
+
+#include <vsg/io/Logger.h>
+#include <vsg/state/Buffer.h>
+#include <vsg/vk/CommandBuffer.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+using namespace vsgCs;
+
+TileParameterBuffer::TileParameterBuffer(const vsg::ref_ptr<vsg::Device>& device, uint32_t slotsPerPage)
+    : _device(device), _slotsPerPage(slotsPerPage)
+{
+    // Both the slots and the regions are addressed with offsets that must be aligned.
+    VkDeviceSize alignment = device->getPhysicalDevice()->getProperties().limits.minUniformBufferOffsetAlignment;
+    alignment = std::max(alignment, VkDeviceSize(1));
+    _stride = (sizeof(pbr::TileParams) + alignment - 1) / alignment * alignment;
+}
+
+TileParameterBuffer::~TileParameterBuffer()
+{
+    for (auto& page : _pages)
+    {
+        page.memory->unmap();
+    }
+}
+
+void TileParameterBuffer::addPage()
+{
+    VkDeviceSize size = _stride * _slotsPerPage * maxRegionCount;
+    // Coherent memory, so there is no need to flush the writes.
+    auto buffer = vsg::createBufferAndMemory(_device, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                             VK_SHARING_MODE_EXCLUSIVE,
+                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                             | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    auto memory = buffer->getDeviceMemory(_device->deviceID);
+    void* mapped = nullptr;
+    if (memory->map(buffer->getMemoryOffset(_device->deviceID), size, 0, &mapped) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Can't map tile parameter buffer");
+    }
+    _pages.push_back(Page{buffer, memory, static_cast<uint8_t*>(mapped)});
+}
+
+uint32_t TileParameterBuffer::allocate(const pbr::TileParams& params)
+{
+    uint32_t slot = 0;
+    if (_freeSlots.empty())
+    {
+        slot = static_cast<uint32_t>(_params.size());
+        if (slot == _pages.size() * _slotsPerPage)
+        {
+            addPage();
+        }
+        _params.push_back(params);
+        _slotVersions.push_back(0);
+    }
+    else
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+        _params[slot] = params;
+    }
+    changed(slot);
+    return slot;
+}
+
+void TileParameterBuffer::free(uint32_t slot)
+{
+    _freeSlots.push_back(slot);
+}
+
+void TileParameterBuffer::set(uint32_t slot, const pbr::TileParams& params)
+{
+    _params[slot] = params;
+    changed(slot);
+}
+
+void TileParameterBuffer::changed(uint32_t slot)
+{
+    ++_version;
+    _slotVersions[slot] = _version;
+    _changes.emplace_back(_version, slot);
+}
+
+vsg::ref_ptr<vsg::BufferInfo> TileParameterBuffer::getBufferInfo(uint32_t slot) const
+{
+    const auto& page = _pages[slot / _slotsPerPage];
+    return vsg::BufferInfo::create(page.buffer, (slot % _slotsPerPage) * _stride, sizeof(pbr::TileParams));
+}
+
+void TileParameterBuffer::flush(const FrameProgress& progress)
+{
+    bool full = false;
+    if (_regions.empty())
+    {
+        _regions.emplace_back();
+        _region = 0;
+        full = true;
+    }
+    else if (_regions[_region].version == _version)
+    {
+        return;
+    }
+    else if (_regions[_region].writtenFrame != progress.frameCount)
+    {
+        // The frames up to this one read the current region, so the changes go to another one.
+        _regions[_region].lastUsedFrame = progress.frameCount - 1;
+        auto region = findFreeRegion(progress);
+        if (!region)
+        {
+            if (_regions.size() == maxRegionCount)
+            {
+                if (!_warnedRegions)
+                {
+                    vsg::warn("TileParameterBuffer: all ", maxRegionCount,
+                              " regions are in use by the GPU; delaying tile parameter changes.");
+                    _warnedRegions = true;
+                }
+                // Still current
+                _regions[_region].lastUsedFrame.reset();
+                return;
+            }
+            _regions.emplace_back();
+            region = static_cast<uint32_t>(_regions.size() - 1);
+            full = true;
+        }
+        _region = *region;
+    }
+    writeRegion(_region, full);
+    _regions[_region].writtenFrame = progress.frameCount;
+    _regions[_region].lastUsedFrame.reset();
+    _dynamicOffset.store(static_cast<uint32_t>(_region * _slotsPerPage * _stride), std::memory_order_relaxed);
+    trimChanges();
+}
+
+std::optional<uint32_t> TileParameterBuffer::findFreeRegion(const FrameProgress& progress)
+{
+    for (uint32_t i = 0; i < _regions.size(); ++i)
+    {
+        if (i != _region && _regions[i].lastUsedFrame && progress.isComplete(*_regions[i].lastUsedFrame))
+        {
+            return i;
+        }
+    }
+    return {};
+}
+
+void TileParameterBuffer::writeRegion(uint32_t region, bool full)
+{
+    VkDeviceSize regionOffset = region * _slotsPerPage * _stride;
+    auto copySlot = [this, regionOffset](uint32_t slot)
+    {
+        auto& page = _pages[slot / _slotsPerPage];
+        std::memcpy(page.mapped + regionOffset + (slot % _slotsPerPage) * _stride, &_params[slot],
+                    sizeof(pbr::TileParams));
+    };
+    auto& regionState = _regions[region];
+    if (full || regionState.version < _changesStart)
+    {
+        for (uint32_t slot = 0; slot < _params.size(); ++slot)
+        {
+            copySlot(slot);
+        }
+    }
+    else
+    {
+        auto itr = std::partition_point(_changes.begin(), _changes.end(),
+                                        [&regionState](const std::pair<uint64_t, uint32_t>& change)
+                                        {
+                                            return change.first <= regionState.version;
+                                        });
+        for (; itr != _changes.end(); ++itr)
+        {
+            // Only the last change of a slot needs to be copied.
+            if (_slotVersions[itr->second] == itr->first)
+            {
+                copySlot(itr->second);
+            }
+        }
+    }
+    regionState.version = _version;
+}
+
+void TileParameterBuffer::trimChanges()
+{
+    uint64_t oldest = _version;
+    for (const auto& region : _regions)
+    {
+        oldest = std::min(oldest, region.version);
+    }
+    auto end = std::partition_point(_changes.begin(), _changes.end(),
+                                    [oldest](const std::pair<uint64_t, uint32_t>& change)
+                                    {
+                                        return change.first <= oldest;
+                                    });
+    // A region that isn't used for a long time gets a full copy instead of a longer change list.
+    if (static_cast<size_t>(_changes.end() - end) > _params.size())
+    {
+        end = _changes.end() - static_cast<std::ptrdiff_t>(_params.size());
+    }
+    if (end != _changes.begin())
+    {
+        _changesStart = std::max(_changesStart, std::prev(end)->first);
+        _changes.erase(_changes.begin(), end);
+    }
+}
+
+BindTileDescriptorSet::BindTileDescriptorSet(const vsg::ref_ptr<TileParameterBuffer>& in_tileParameters,
+                                             VkPipelineBindPoint in_bindPoint,
+                                             const vsg::ref_ptr<vsg::PipelineLayout>& in_layout,
+                                             uint32_t in_firstSet,
+                                             const vsg::ref_ptr<vsg::DescriptorSet>& in_descriptorSet)
+    : Inherit(in_bindPoint, in_layout, in_firstSet, in_descriptorSet), _tileParameters(in_tileParameters)
+{
+}
+
+void BindTileDescriptorSet::record(vsg::CommandBuffer& commandBuffer) const
+{
+    VkDescriptorSet vkDescriptorSet = descriptorSet->vk(commandBuffer.deviceID);
+    uint32_t dynamicOffset = _tileParameters->getDynamicOffset();
+    vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout->vk(commandBuffer.deviceID), firstSet,
+                            1, &vkDescriptorSet, 1, &dynamicOffset);
+}
@@ -0,0 +1,150 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#pragma once
+
+#include "vsgCs/Export.h"
+#include "GraphicsEnvironment.h"
+#include "pbr.h"
+
+#include <vsg/commands/BindDescriptorSet.h>
+#include <vsg/state/BufferInfo.h>
+#include <vsg/vk/Device.h>
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vsgCs
+{
+    /**
+     * @brief The parameters (pbr::TileParams) of all tiles, in persistently mapped uniform buffers.
+     *
+     * Each tile has a slot, which is bound in its TILE_DESCRIPTOR_SET descriptor set. Changes
+     * (fading, overlays) are made to a copy in main memory and copied to the mapped buffers once
+     * per frame by flush(). The buffers hold several copies of all the slots, "regions," so that
+     * a region can be written while frames in flight read the others. A region is only reused
+     * once the GPU has finished the last frame that used it; if none is free, another one is
+     * used, up to maxRegionCount. Only the slots that changed since a region was last written are
+     * copied to it. The region in use is selected by the dynamic offset of the tile's descriptor
+     * set binding, supplied by BindTileDescriptorSet.
+     *
+     * The slots are allocated in pages of buffers, so existing descriptor sets don't have to change
+     * when more slots are needed. All the functions except getDynamicOffset() must be called
+     * from the main thread.
+     */
+    class VSGCS_EXPORT TileParameterBuffer : public vsg::Inherit<vsg::Object, TileParameterBuffer>
+    {
+    public:
+        // Space is reserved for this many regions in each page, but they are only used when the
+        // GPU falls behind.
+        static constexpr uint32_t maxRegionCount = 8;
+
+        explicit TileParameterBuffer(const vsg::ref_ptr<vsg::Device>& device, uint32_t slotsPerPage = 1024);
+        ~TileParameterBuffer() override;
+        uint32_t allocate(const pbr::TileParams& params);
+        /**
+         * @brief Release a slot. Frames in flight only use their own copy, so the slot can be reused
+         * immediately.
+         */
+        void free(uint32_t slot);
+        const pbr::TileParams& get(uint32_t slot) const
+        {
+            return _params[slot];
+        }
+        void set(uint32_t slot, const pbr::TileParams& params);
+        /**
+         * @brief The buffer range of the slot, for the tile's descriptor set.
+         */
+        vsg::ref_ptr<vsg::BufferInfo> getBufferInfo(uint32_t slot) const;
+        /**
+         * @brief Copy the changed parameters to the mapped buffers. This can be called several
+         * times in a frame; the parameters must be flushed after the last change and before
+         * the frame is recorded. If every region is still in use by the GPU, the changes are
+         * left for a later flush.
+         */
+        void flush(const FrameProgress& progress);
+        uint32_t getDynamicOffset() const
+        {
+            return _dynamicOffset.load(std::memory_order_relaxed);
+        }
+    protected:
+        struct Page
+        {
+            vsg::ref_ptr<vsg::Buffer> buffer;
+            vsg::ref_ptr<vsg::DeviceMemory> memory;
+            uint8_t* mapped = nullptr;
+        };
+        struct Region
+        {
+            // _version when the region was last written
+            uint64_t version = 0;
+            // The frame in which the region was last written
+            uint64_t writtenFrame = 0;
+            // The last frame that was recorded using the region, once another region is current
+            std::optional<uint64_t> lastUsedFrame;
+        };
+        void addPage();
+        void changed(uint32_t slot);
+        std::optional<uint32_t> findFreeRegion(const FrameProgress& progress);
+        void writeRegion(uint32_t region, bool full);
+        void trimChanges();
+        vsg::ref_ptr<vsg::Device> _device;
+        VkDeviceSize _stride;
+        uint32_t _slotsPerPage;
+        std::vector<Page> _pages;
+        std::vector<pbr::TileParams> _params;
+        std::vector<uint32_t> _freeSlots;
+        // Incremented when any parameter changes
+        uint64_t _version = 0;
+        // The version of each slot's last change
+        std::vector<uint64_t> _slotVersions;
+        // (version, slot) of the changes after _changesStart, in version order
+        std::vector<std::pair<uint64_t, uint32_t>> _changes;
+        uint64_t _changesStart = 0;
+        std::vector<Region> _regions;
+        uint32_t _region = 0;
+        bool _warnedRegions = false;
+        std::atomic<uint32_t> _dynamicOffset = 0;
+    };
+
+    /**
+     * @brief Bind a tile's descriptor set with the dynamic offset of the current
+     * TileParameterBuffer region.
+     */
+    class VSGCS_EXPORT BindTileDescriptorSet : public vsg::Inherit<vsg::BindDescriptorSet, BindTileDescriptorSet>
+    {
+    public:
+        BindTileDescriptorSet(const vsg::ref_ptr<TileParameterBuffer>& in_tileParameters,
+                              VkPipelineBindPoint in_bindPoint,
+                              const vsg::ref_ptr<vsg::PipelineLayout>& in_layout, uint32_t in_firstSet,
+                              const vsg::ref_ptr<vsg::DescriptorSet>& in_descriptorSet);
+        void record(vsg::CommandBuffer& commandBuffer) const override;
+    protected:
+        vsg::ref_ptr<TileParameterBuffer> _tileParameters;
+    };
+}
@@ -26,11 +26,15 @@ SOFTWARE.
 
 #include "CsOverlay.h"
 #include "jsonUtils.h"
+#include "MainThreadScheduler.h"
 #include "OpThreadTaskProcessor.h"
 #include "pbr.h"
+#include "PredictedView.h"
 #include "RuntimeEnvironment.h"
+#include "TileParameterBuffer.h"
 #include "Tracing.h"
 #include "UrlAssetAccessor.h"
+#include "vsgResourcePreparer.h"
 
 #include <CesiumUtility/JsonHelpers.h>
 #include <Cesium3DTilesSelection/TilesetMetadata.h>
@@ -38,6 +42,7 @@ SOFTWARE.
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <algorithm>
 #include <optional>
 #include <cmath>
 #include <vsg/core/ref_ptr.h>
@@ -81,7 +86,8 @@ TilesetNode::TilesetNode(const DeviceFeatures& deviceFeatures, const TilesetSour
     Cesium3DTilesSelection::TilesetOptions options(tilesetOptions);
     // turn off all the unsupported stuff
     options.enableOcclusionCulling = false;
-    // Generous per-frame time limits for loading / unloading on main thread.
+    // Per-frame time limits for loading / unloading on main thread. These are set from
+    // MainThreadScheduler's budget every frame.
     options.mainThreadLoadingTimeLimit = 5.0;
     options.tileCacheUnloadTimeLimit = 5.0;
     options.contentOptions.enableWaterMask = false;
@@ -147,6 +153,7 @@ void TilesetNode::shutdown()
         {
             overlay->removeFromTileset(ref_this);
         }
+        _prefetchViewGroup.reset();
         ++_tilesetsBeingDestroyed;
         _tileset->getAsyncDestructionCompleteEvent().thenInMainThread(
             [this]()
@@ -274,7 +281,8 @@ struct ViewData : public vsg::Inherit<vsg::Object, ViewData>
 namespace
 {
     std::optional<Cesium3DTilesSelection::ViewState>
-    createViewState(const vsg::ref_ptr<vsg::View>& view, const vsg::ref_ptr<vsg::RenderGraph>& renderGraph)
+    createViewState(const vsg::ref_ptr<vsg::View>& view, const vsg::ref_ptr<vsg::RenderGraph>& renderGraph,
+                    const vsg::dmat4& viewMatrix)
     {
         auto* viewData = dynamic_cast<ViewData*>(view->getObject("vsgCsViewData"));
         if (!viewData)
@@ -282,7 +290,7 @@ namespace
             return {};
         }
         vsg::dmat4 Pw = vsg::computeTransform(viewData->tilesetPath);
-        vsg::dmat4 PcsInv = TilesetNode::yUp2zUp * view->camera->viewMatrix->transform() * Pw;
+        vsg::dmat4 PcsInv = TilesetNode::yUp2zUp * viewMatrix * Pw;
         vsg::dmat4 Pcs = vsg::inverse(PcsInv);
         glm::dvec3 position(Pcs[3][0], Pcs[3][1], Pcs[3][2]);
         glm::dvec3 direction(Pcs[1][0], Pcs[1][1], Pcs[1][2]);
@@ -301,9 +309,15 @@ namespace
             viewportSize[1] = renderGraph->renderArea.extent.height;
         }
         Cesium3DTilesSelection::ViewState result =
-            Cesium3DTilesSelection::ViewState(vsg2glm(view->camera->viewMatrix->transform()), vsg2glm(projMat->transform()), viewportSize);
+            Cesium3DTilesSelection::ViewState(vsg2glm(viewMatrix), vsg2glm(projMat->transform()), viewportSize);
         return {result};
     }
+
+    std::optional<Cesium3DTilesSelection::ViewState>
+    createViewState(const vsg::ref_ptr<vsg::View>& view, const vsg::ref_ptr<vsg::RenderGraph>& renderGraph)
+    {
+        return createViewState(view, renderGraph, view->camera->viewMatrix->transform());
+    }
 }
     
 void TilesetNode::updateViews(const vsg::ref_ptr<vsg::Viewer>& viewer)
@@ -334,15 +348,18 @@ namespace
             const auto* renderResources
                 = reinterpret_cast<const RenderResources*>(tileContent.getRenderContent()
                                                            ->getRenderResources());
-            auto uboData = CesiumGltfBuilder::getTileData(renderResources->model);
-            if (uboData)
+            // Tiles can be in the view update result before they are prepared.
+            if (renderResources)
             {
+                auto& tileParameters = *RuntimeEnvironment::get()->genv->tileParameters;
                 auto fadePercentage = tileContent.getRenderContent()->getLodTransitionFadePercentage();
-                auto [fadeValue, oldFadeOut] = pbr::getFadeValue(uboData);
-                if (fadeValue != fadePercentage || fadeOut != oldFadeOut)
+                float fadeOutValue = fadeOut ? 1.0f : 0.0f;
+                auto params = tileParameters.get(renderResources->parameterSlot);
+                if (params.fadeValue != fadePercentage || params.fadeOut != fadeOutValue)
                 {
-                    pbr::setFadeValue(uboData, fadePercentage, fadeOut);
-                    uboData->dirty();
+                    params.fadeValue = fadePercentage;
+                    params.fadeOut = fadeOutValue;
+                    tileParameters.set(renderResources->parameterSlot, params);
                 }
             }
         }
@@ -376,7 +393,15 @@ void TilesetNode::UpdateTileset::run()
                           viewStates.push_back(viewState.value());
                       }
                   });
-    getAsyncSystem().dispatchMainThreadTasks();
+    auto& scheduler = getMainThreadScheduler();
+    scheduler.beginFrame(currentFrameStamp->frameCount, currentFrameStamp->time);
+    scheduler.dispatch();
+    if (ref_tileset->_prefetchViewGroup)
+    {
+        VSGCS_ZONESCOPEDN("update prefetch views");
+        auto predictedStates = ref_tileset->predictViewStates(ref_viewer, currentFrameStamp->time);
+        tileset.updateViewGroup(*ref_tileset->_prefetchViewGroup, predictedStates, deltaTime);
+    }
     ref_tileset->_viewUpdateResult = &tileset.updateViewGroup(tileset.getDefaultViewGroup(), viewStates, deltaTime);
     for (const auto& tile : ref_tileset->_viewUpdateResult->tilesToRenderThisFrame)
     {
@@ -386,7 +411,32 @@ void TilesetNode::UpdateTileset::run()
     {
         fadeTile(tile, true);
     }
+    // Cesium's main thread loading gets what is left of the budget. A limit of 0 means no limit,
+    // but Cesium always finishes at least one tile, so a tiny limit is enough to make progress.
+    double timeLimit = std::max(scheduler.remaining(), 0.001);
+    tileset.getOptions().mainThreadLoadingTimeLimit = timeLimit;
+    // Unloading frees memory and has to keep up with loading.
+    tileset.getOptions().tileCacheUnloadTimeLimit
+        = std::max(scheduler.remaining(), scheduler.getOptions().minimumUnloadTime);
+    auto loadStart = MainThreadScheduler::clock::now();
     tileset.loadTiles();
+    scheduler.charge(MainThreadScheduler::clock::now() - loadStart);
+    // Compile the new tiles and raster changes in one batch, and copy the fades and raster changes
+    // of this tileset, before the frame is recorded.
+    auto preparer = std::dynamic_pointer_cast<vsgResourcePreparer>(tileset.getExternals().pPrepareRendererResources);
+    // Without a resource preparer there is no record of the frames the GPU has finished, so
+    // regions aren't reused.
+    FrameProgress progress{currentFrameStamp->frameCount, std::nullopt};
+    if (preparer)
+    {
+        preparer->compilePending();
+        vsg::ref_ptr<vsg::Viewer> ref_viewer = preparer->viewer;
+        if (ref_viewer)
+        {
+            progress = preparer->getDeletionQueue().getProgress(ref_viewer);
+        }
+    }
+    RuntimeEnvironment::get()->genv->tileParameters->flush(progress);
     ref_tileset->_lastFrameStamp = currentFrameStamp;
 }
 
@@ -414,8 +464,97 @@ void TilesetNode::removeOverlay(const vsg::ref_ptr<CsOverlay>& overlay)
     _overlays.erase(std::remove(_overlays.begin(), _overlays.end(), overlay), _overlays.end());
 }
 
+void TilesetNode::setPrefetch(const PrefetchOptions& options)
+{
+    _prefetchOptions = options;
+    _prefetchViewGroup = std::make_unique<Cesium3DTilesSelection::TilesetViewGroup>();
+    _prefetchViewGroup->setWeight(options.weight);
+}
+
+std::vector<Cesium3DTilesSelection::ViewState>
+TilesetNode::predictViewStates(const vsg::ref_ptr<vsg::Viewer>& viewer, vsg::time_point now)
+{
+    std::vector<Cesium3DTilesSelection::ViewState> result;
+    std::map<const vsg::View*, CameraHistory> history;
+    for_each_view(viewer,
+                  [&](const vsg::ref_ptr<vsg::View>& view, const vsg::ref_ptr<vsg::RenderGraph>& rg)
+                  {
+                      vsg::dmat4 viewMatrix = view->camera->viewMatrix->transform();
+                      vsg::dmat4 pose = vsg::inverse(viewMatrix);
+                      CameraHistory current{now, vsg::dvec3(pose[3][0], pose[3][1], pose[3][2]),
+                                            vsg::dvec3(0.0, 0.0, 0.0)};
+                      auto itr = _cameraHistory.find(view.get());
+                      if (itr != _cameraHistory.end())
+                      {
+                          std::chrono::duration<double> dt = now - itr->second.time;
+                          if (dt.count() > 0.0)
+                          {
+                              // Smooth out frame time jitter.
+                              auto velocity = (current.eye - itr->second.eye) / dt.count();
+                              current.velocity = (velocity + itr->second.velocity) * 0.5;
+                          }
+                          else
+                          {
+                              current.velocity = itr->second.velocity;
+                          }
+                      }
+                      history[view.get()] = current;
+                      // A known destination beats extrapolation.
+                      auto predicted = view->camera->getObject<PredictedView>(PredictedView::objectName);
+                      if (predicted && predicted->arrival > now)
+                      {
+                          if (auto viewState = createViewState(view, rg, predicted->viewMatrix))
+                          {
+                              result.push_back(viewState.value());
+                          }
+                          return;
+                      }
+                      if (vsg::length(current.velocity) < _prefetchOptions->minimumSpeed)
+                      {
+                          return;
+                      }
+                      vsg::dvec3 offset = current.velocity * _prefetchOptions->lookAhead;
+                      pose[3][0] += offset.x;
+                      pose[3][1] += offset.y;
+                      pose[3][2] += offset.z;
+                      if (auto viewState = createViewState(view, rg, vsg::inverse(pose)))
+                      {
+                          result.push_back(viewState.value());
+                      }
+                  });
+    // Forget views that are gone.
+    _cameraHistory = std::move(history);
+    return result;
+}
+
 namespace
 {
+    std::optional<PrefetchOptions> readPrefetch(const rapidjson::Value& json, bool defaultEnabled)
+    {
+        const auto itr = json.FindMember("prefetch");
+        PrefetchOptions result;
+        if (itr == json.MemberEnd())
+        {
+            return defaultEnabled ? std::optional(result) : std::nullopt;
+        }
+        if (itr->value.IsBool())
+        {
+            return itr->value.GetBool() ? std::optional(result) : std::nullopt;
+        }
+        if (!itr->value.IsObject())
+        {
+            vsg::warn("prefetch should be a boolean or an object");
+            return {};
+        }
+        const auto& valueJson = itr->value;
+        using CesiumUtility::JsonHelpers;
+        result.lookAhead = JsonHelpers::getDoubleOrDefault(valueJson, "lookAhead", result.lookAhead);
+        result.weight = JsonHelpers::getDoubleOrDefault(valueJson, "weight", result.weight);
+        result.minimumSpeed = JsonHelpers::getDoubleOrDefault(valueJson, "minimumSpeed",
+                                                              result.minimumSpeed);
+        return result;
+    }
+
     vsg::ref_ptr<vsg::Object> buildTilesetNode(const rapidjson::Value& json,
                                                JSONObjectFactory* factory,
                                                const vsg::ref_ptr<vsg::Object>&)
@@ -464,7 +603,17 @@ namespace
         {
             tileOptions.rendererOptions = Styling::create();
         }
+        // With adaptive concurrency, the per-host request limits govern the tile loads.
+        const auto& adaptiveConcurrency = env->getAdaptiveConcurrency();
+        if (adaptiveConcurrency)
+        {
+            tileOptions.maximumSimultaneousTileLoads = adaptiveConcurrency->maximum;
+        }
         auto tilesetNode = vsgCs::TilesetNode::create(env->features, source, tileOptions, env->options);
+        if (auto prefetch = readPrefetch(json, env->prefetch))
+        {
+            tilesetNode->setPrefetch(*prefetch);
+        }
         const auto itr = json.FindMember("overlays");
         if (itr != json.MemberEnd() && itr->value.IsArray())
         {
@@ -480,6 +629,10 @@ namespace
                     break;
                 }
                 overlay->layerNumber = i;
+                if (adaptiveConcurrency)
+                {
+                    overlay->MaximumSimultaneousTileLoads = adaptiveConcurrency->maximum;
+                }
                 overlay->addToTileset(tilesetNode);
             }
         }
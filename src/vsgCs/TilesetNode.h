@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/all.h>
 #include "Cesium3DTilesSelection/Tileset.h"
+#include "Cesium3DTilesSelection/TilesetViewGroup.h"
 #include "Cesium3DTilesSelection/ViewUpdateResult.h"
 #include "vsgCs/Export.h"
 #include "RuntimeEnvironment.h"
@@ -21,6 +22,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "runtimeSupport.h"
 #include "vsgResourcePreparer.h"
 
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -33,6 +35,19 @@ namespace vsgCs
 {
     class CsOverlay;
 
+    /**
+     * @brief Options for loading tiles ahead of the camera.
+     */
+    struct PrefetchOptions
+    {
+        // How far ahead, in seconds, to extrapolate the camera's motion
+        double lookAhead = 2.0;
+        // Share of tile loading given to the look-ahead views, relative to 1 for the real views
+        double weight = 0.25;
+        // Cameras moving slower than this (meters / second) are not extrapolated.
+        double minimumSpeed = 1.0;
+    };
+
     struct VSGCS_EXPORT TilesetSource
     {
         std::optional<std::string> url;
@@ -87,6 +102,15 @@ namespace vsgCs
         // probably don't want to call these; use CsOverlay::addTotileset instead.
         void addOverlay(const vsg::ref_ptr<CsOverlay>& overlay);
         void removeOverlay(const vsg::ref_ptr<CsOverlay>& overlay);
+        /**
+         * @brief Load tiles along the cameras' paths before they come into view.
+         *
+         * Each frame, every camera's motion is extrapolated lookAhead seconds from its recent
+         * poses, or, if a manipulator has attached a PredictedView to the camera, its destination
+         * is used. These look-ahead views are submitted to a separate view group of lower weight,
+         * so their tiles load without delaying those of the real views.
+         */
+        void setPrefetch(const PrefetchOptions& options);
         vsg::ref_ptr<Styling> styling;
     protected:
         const Cesium3DTilesSelection::ViewUpdateResult* _viewUpdateResult;
@@ -96,6 +120,18 @@ namespace vsgCs
     private:
         template<class V> void t_traverse(V& visitor) const;
         int32_t _tilesetsBeingDestroyed;
+        struct CameraHistory
+        {
+            vsg::time_point time;
+            vsg::dvec3 eye;
+            vsg::dvec3 velocity;
+        };
+        std::vector<Cesium3DTilesSelection::ViewState>
+        predictViewStates(const vsg::ref_ptr<vsg::Viewer>& viewer, vsg::time_point now);
+        std::optional<PrefetchOptions> _prefetchOptions;
+        // Destroyed before the tileset
+        std::unique_ptr<Cesium3DTilesSelection::TilesetViewGroup> _prefetchViewGroup;
+        std::map<const vsg::View*, CameraHistory> _cameraHistory;
         
     };
 }
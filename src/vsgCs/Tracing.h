@@ -33,11 +33,13 @@ SOFTWARE.
 #define VSGCS_ZONESCOPED ZoneScoped
 #define VSGCS_ZONESCOPEDN(name) ZoneScopedN(name)
 #define VSGCS_FRAMEMARK FrameMark
+#define VSGCS_PLOT(name, value) TracyPlot(name, value)
 
 #else
 #define VSGCS_ZONESCOPED
 #define VSGCS_ZONESCOPEDN(name)
 #define VSGCS_FRAMEMARK
+#define VSGCS_PLOT(name, value)
 #endif
 
 #include <vsg/core/Object.h>
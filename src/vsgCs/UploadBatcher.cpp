@@ -0,0 +1,178 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#include "UploadBatcher.h"
+
+#include "OpThreadTaskProcessor.h"
+#include "TaskStatistics.h"
+#include "Tracing.h"
+
+#include <exception>
+
+using namespace vsgCs;
+
+UploadBatcher::UploadBatcher(const UploadBatchOptions& options)
+    : _options(options)
+{
+}
+
+UploadBatcher::~UploadBatcher()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]()
+    {
+        return _activeFlushes == 0;
+    });
+}
+
+void UploadBatcher::setOptions(const UploadBatchOptions& options)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _options = options;
+}
+
+CesiumAsync::Future<std::shared_ptr<UploadBatch>>
+UploadBatcher::compile(const vsg::ref_ptr<vsg::Viewer>& viewer, const vsg::ref_ptr<vsg::Object>& object)
+{
+    auto& asyncSystem = getAsyncSystem();
+    auto promise = asyncSystem.createPromise<std::shared_ptr<UploadBatch>>();
+    auto future = promise.getFuture();
+    bool scheduleFlush = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _viewer = viewer;
+        _pending.push_back(Pending{object, std::move(promise)});
+        if (!_flushScheduled)
+        {
+            _flushScheduled = true;
+            ++_activeFlushes;
+            _batchStart = std::chrono::steady_clock::now();
+            scheduleFlush = true;
+        }
+        else if (_pending.size() >= _options.maxObjects)
+        {
+            _full.notify_one();
+        }
+    }
+    if (scheduleFlush)
+    {
+        // The flush task collects the batch for the rest of the window, then compiles it. Its run
+        // time is recorded by compileBatch(), without the window.
+        getTaskStatistics().taskQueued(TaskCategory::Compile);
+        asyncSystem.runInThreadPool(getUploadThreadPool(),
+                                    [this, queueTime = TaskStatistics::clock::now()]()
+                                    {
+                                        getTaskStatistics().taskStarted(TaskCategory::Compile, queueTime,
+                                                                        TaskStatistics::clock::now());
+                                        flush();
+                                    });
+    }
+    return future;
+}
+
+std::shared_ptr<UploadBatch>
+UploadBatcher::compileNow(const vsg::ref_ptr<vsg::Viewer>& viewer, const vsg::ref_ptr<vsg::Object>& object)
+{
+    auto promise = getAsyncSystem().createPromise<std::shared_ptr<UploadBatch>>();
+    auto future = promise.getFuture();
+    std::vector<Pending> batch;
+    {
+        // The scheduled flush will find nothing left to compile.
+        std::lock_guard<std::mutex> lock(_mutex);
+        batch.swap(_pending);
+    }
+    batch.push_back(Pending{object, std::move(promise)});
+    compileBatch(viewer, batch);
+    return future.wait();
+}
+
+void UploadBatcher::flush()
+{
+    std::vector<Pending> batch;
+    vsg::ref_ptr<vsg::Viewer> viewer;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto deadline = _batchStart
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(_options.window);
+        _full.wait_until(lock, deadline,
+                         [this]()
+                         {
+                             return _pending.size() >= _options.maxObjects;
+                         });
+        batch.swap(_pending);
+        _flushScheduled = false;
+        viewer = _viewer;
+    }
+    if (!batch.empty())
+    {
+        compileBatch(viewer, batch);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_activeFlushes;
+    _idle.notify_all();
+}
+
+void UploadBatcher::compileBatch(const vsg::ref_ptr<vsg::Viewer>& viewer, std::vector<Pending>& batch)
+{
+    VSGCS_ZONESCOPEDN("compile batch");
+    TaskTimer timer(TaskCategory::Compile);
+    VSGCS_PLOT("upload batch size", static_cast<int64_t>(batch.size()));
+    auto result = std::make_shared<UploadBatch>();
+    if (viewer)
+    {
+        auto objects = vsg::Objects::create();
+        for (auto& pending : batch)
+        {
+            objects->children.push_back(pending.object);
+        }
+        try
+        {
+            result->compileResult = viewer->compileManager->compile(objects);
+        }
+        catch (...)
+        {
+            auto exception = std::current_exception();
+            for (auto& pending : batch)
+            {
+                pending.promise.reject(exception);
+            }
+            return;
+        }
+    }
+    for (auto& pending : batch)
+    {
+        pending.promise.resolve(result);
+    }
+}
+
+void UploadBatcher::apply(vsg::Viewer& viewer, UploadBatch& batch)
+{
+    if (batch.applied)
+    {
+        return;
+    }
+    vsg::updateViewer(viewer, batch.compileResult);
+    batch.applied = true;
+}
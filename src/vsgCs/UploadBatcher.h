@@ -0,0 +1,117 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/Promise.h>
+#include <vsg/all.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vsgCs
+{
+    struct UploadBatchOptions
+    {
+        // How long to collect objects before compiling them
+        std::chrono::duration<double, std::milli> window{2.0};
+        // A batch is compiled as soon as it has this many objects.
+        size_t maxObjects = 32;
+    };
+
+    /**
+     * @brief The result of compiling a batch of objects, shared by all of them.
+     */
+    struct UploadBatch
+    {
+        vsg::CompileResult compileResult;
+        bool applied = false;
+    };
+
+    /**
+     * @brief Compiles the tiles and rasters prepared by the load threads in batches.
+     *
+     * Each vsg::CompileManager::compile() call takes a compile traversal, records and submits its
+     * own transfer commands, and waits for them. Instead of doing that per tile, the batcher
+     * collects the objects that arrive within a short window and compiles them as one
+     * vsg::Objects group in the upload thread pool: one compile traversal, one transfer
+     * submission and one wait for the whole batch. The staging memory comes from the compile
+     * context's staging buffer pool, which persists across compiles.
+     */
+    class VSGCS_EXPORT UploadBatcher
+    {
+    public:
+        explicit UploadBatcher(const UploadBatchOptions& options = {});
+        /**
+         * @brief Waits for scheduled batches to finish, as their tasks refer to the batcher.
+         */
+        ~UploadBatcher();
+        UploadBatcher(const UploadBatcher&) = delete;
+        UploadBatcher& operator=(const UploadBatcher&) = delete;
+        void setOptions(const UploadBatchOptions& options);
+        /**
+         * @brief Compile an object in the next batch.
+         *
+         * The future resolves in the upload pool once the batch is compiled.
+         */
+        CesiumAsync::Future<std::shared_ptr<UploadBatch>>
+        compile(const vsg::ref_ptr<vsg::Viewer>& viewer, const vsg::ref_ptr<vsg::Object>& object);
+        /**
+         * @brief Compile an object now, in the calling thread, for callers that would otherwise
+         * block for the batch window. Objects waiting for the window are compiled with it.
+         */
+        std::shared_ptr<UploadBatch>
+        compileNow(const vsg::ref_ptr<vsg::Viewer>& viewer, const vsg::ref_ptr<vsg::Object>& object);
+        /**
+         * @brief Merge a batch's compile result into the viewer, in the main thread. Only the
+         * first call for a batch has an effect.
+         */
+        static void apply(vsg::Viewer& viewer, UploadBatch& batch);
+    private:
+        struct Pending
+        {
+            vsg::ref_ptr<vsg::Object> object;
+            CesiumAsync::Promise<std::shared_ptr<UploadBatch>> promise;
+        };
+        void flush();
+        void compileBatch(const vsg::ref_ptr<vsg::Viewer>& viewer, std::vector<Pending>& batch);
+        std::mutex _mutex;
+        std::condition_variable _full;
+        std::condition_variable _idle;
+        UploadBatchOptions _options;
+        std::vector<Pending> _pending;
+        vsg::observer_ptr<vsg::Viewer> _viewer;
+        bool _flushScheduled = false;
+        // Flush tasks that are scheduled or running
+        size_t _activeFlushes = 0;
+        std::chrono::steady_clock::time_point _batchStart;
+    };
+}
@@ -24,21 +24,117 @@ SOFTWARE.
 
 #include "UrlAssetAccessor.h"
 
+#include "MappedFile.h"
+#include "OpThreadTaskProcessor.h"
+#include "TaskStatistics.h"
 #include "Tracing.h"
 #include "vsgCs/Version.h"
 
 #include <CesiumAsync/IAssetResponse.h>
 
+#include <vsg/io/Logger.h>
+
+#include <gsl/util>
+
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <map>
+#include <thread>
+#include <unordered_map>
 #include <curl/curl.h>
 
 
 using namespace vsgCs;
 
+namespace vsgCs
+{
+    // Response buffers are recycled between requests so that a large tile doesn't need fresh
+    // memory from the allocator, which is then faulted in page by page. The pool holds at most
+    // maxBytes; the oldest buffers are freed to make room for new ones.
+
+    class ByteBufferPool
+    {
+    public:
+        ByteBufferPool(size_t maxBytes, size_t maxBufferSize)
+            : _maxBytes(maxBytes), _maxBufferSize(maxBufferSize)
+        {
+        }
+
+        // Return an empty buffer whose capacity is at least minCapacity.
+        std::vector<std::byte> acquire(size_t minCapacity)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                // Best fit
+                auto best = _buffers.end();
+                for (auto itr = _buffers.begin(); itr != _buffers.end(); ++itr)
+                {
+                    if (itr->capacity() >= minCapacity
+                        && (best == _buffers.end() || itr->capacity() < best->capacity()))
+                    {
+                        best = itr;
+                    }
+                }
+                if (best != _buffers.end())
+                {
+                    std::vector<std::byte> result = std::move(*best);
+                    _buffers.erase(best);
+                    _bytes -= result.capacity();
+                    return result;
+                }
+            }
+            std::vector<std::byte> result;
+            result.reserve(minCapacity);
+            return result;
+        }
+
+        void release(std::vector<std::byte>&& buffer)
+        {
+            if (buffer.capacity() == 0 || buffer.capacity() > _maxBufferSize
+                || buffer.capacity() > _maxBytes)
+            {
+                return;
+            }
+            buffer.clear();
+            std::vector<std::vector<std::byte>> freed;
+            std::lock_guard<std::mutex> lock(_mutex);
+            while (_bytes + buffer.capacity() > _maxBytes)
+            {
+                _bytes -= _buffers.front().capacity();
+                freed.push_back(std::move(_buffers.front()));
+                _buffers.pop_front();
+            }
+            _bytes += buffer.capacity();
+            _buffers.push_back(std::move(buffer));
+        }
+    private:
+        std::mutex _mutex;
+        std::deque<std::vector<std::byte>> _buffers;
+        size_t _bytes = 0;
+        const size_t _maxBytes;
+        const size_t _maxBufferSize;
+    };
+}
+
 class UrlAssetResponse : public CesiumAsync::IAssetResponse
 {
 public:
+    explicit UrlAssetResponse(std::shared_ptr<ByteBufferPool> pool)
+        : _pool(std::move(pool))
+    {
+    }
+
+    ~UrlAssetResponse() override
+    {
+        _pool->release(std::move(_result));
+    }
+
+    UrlAssetResponse(const UrlAssetResponse&) = delete;
+    UrlAssetResponse& operator=(const UrlAssetResponse&) = delete;
+
     uint16_t statusCode() const override
     {
         return _statusCode;
@@ -59,13 +155,53 @@ public:
         return {const_cast<const std::byte*>(_result.data()), _result.size()};
     }
 
+    // Largest buffer allocated up front for a Content-Length header
+    static constexpr size_t maxReserveSize = 64 * 1024 * 1024;
     static size_t headerCallback(char* buffer, size_t size, size_t nitems, void *userData);
     static size_t dataCallback(char* buffer, size_t size, size_t nitems, void *userData);
     void setCallbacks(CURL* curl);
+    // Make room for size bytes of data in the result.
+    void reserve(size_t size);
     uint16_t _statusCode = 0;
     std::string _contentType;
     CesiumAsync::HttpHeaders _headers;
     std::vector<std::byte> _result;
+private:
+    std::shared_ptr<ByteBufferPool> _pool;
+};
+
+// A response whose data is a memory-mapped local file, for file: URLs.
+
+class MappedFileResponse : public CesiumAsync::IAssetResponse
+{
+public:
+    explicit MappedFileResponse(std::shared_ptr<MappedFile> file)
+        : _file(std::move(file))
+    {
+    }
+
+    uint16_t statusCode() const override
+    {
+        return 200;
+    }
+
+    std::string contentType() const override
+    {
+        return {};
+    }
+
+    const CesiumAsync::HttpHeaders& headers() const override
+    {
+        return _headers;
+    }
+
+    std::span<const std::byte> data() const override
+    {
+        return _file->data();
+    }
+private:
+    std::shared_ptr<MappedFile> _file;
+    CesiumAsync::HttpHeaders _headers;
 };
 
 class UrlAssetRequest : public CesiumAsync::IAssetRequest
@@ -106,7 +242,7 @@ public:
         return this->_response.get();
     }
 
-    void setResponse(std::unique_ptr<UrlAssetResponse> response)
+    void setResponse(std::unique_ptr<CesiumAsync::IAssetResponse> response)
     {
         _response = std::move(response);
     }
@@ -114,7 +250,7 @@ private:
     std::string _method;
     std::string _url;
     CesiumAsync::HttpHeaders _headers;
-    std::unique_ptr<UrlAssetResponse> _response;
+    std::unique_ptr<CesiumAsync::IAssetResponse> _response;
 };
 
 size_t UrlAssetResponse::headerCallback(char* buffer, size_t size, size_t nitems, void *userData)
@@ -135,7 +271,24 @@ size_t UrlAssetResponse::headerCallback(char* buffer, size_t size, size_t nitems
         {
             ++value;
         }
-        response->_headers.insert({std::string(buffer, colon), std::string(value, end)});
+        std::string name(buffer, colon);
+        response->_headers.insert({name, std::string(value, end)});
+        // With a known length, the data lands in the buffer without any reallocation. If the
+        // response is compressed the length is only a lower bound, but it's still a good start.
+        // The header comes from the server, so don't trust it with more than maxReserveSize.
+        if (std::equal(name.begin(), name.end(), "content-length", "content-length" + 14,
+                       [](char a, char b)
+                       {
+                           return std::tolower(static_cast<unsigned char>(a)) == b;
+                       }))
+        {
+            unsigned long long contentLength = std::strtoull(value, nullptr, 10);
+            if (contentLength > 0)
+            {
+                response->reserve(static_cast<size_t>(std::min<unsigned long long>(contentLength,
+                                                                                   maxReserveSize)));
+            }
+        }
         auto contentTypeItr = response->_headers.find("content-type");
         if (contentTypeItr != response->_headers.end())
         {
@@ -145,9 +298,18 @@ size_t UrlAssetResponse::headerCallback(char* buffer, size_t size, size_t nitems
     return cnt;
 }
 
+// Exceptions mustn't propagate through libcurl; returning a short count aborts the transfer.
+
 extern "C" size_t headerCallback(char* buffer, size_t size, size_t nitems, void *userData)
 {
-    return UrlAssetResponse::headerCallback(buffer, size, nitems, userData);
+    try
+    {
+        return UrlAssetResponse::headerCallback(buffer, size, nitems, userData);
+    }
+    catch (...)
+    {
+        return 0;
+    }
 }
 
 size_t UrlAssetResponse::dataCallback(char* buffer, size_t size, size_t nitems, void *userData)
@@ -159,13 +321,42 @@ size_t UrlAssetResponse::dataCallback(char* buffer, size_t size, size_t nitems,
         return cnt;
     }
     auto* bufPtr = reinterpret_cast<std::byte*>(buffer);
+    if (response->_result.capacity() - response->_result.size() < cnt)
+    {
+        response->reserve(response->_result.size() + cnt);
+    }
     response->_result.insert(response->_result.end(), bufPtr, bufPtr + cnt);
     return cnt;
 }
 
 extern "C" size_t dataCallback(char* buffer, size_t size, size_t nitems, void *userData)
 {
-    return UrlAssetResponse::dataCallback(buffer, size, nitems, userData);
+    try
+    {
+        return UrlAssetResponse::dataCallback(buffer, size, nitems, userData);
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+void UrlAssetResponse::reserve(size_t size)
+{
+    if (_result.capacity() >= size)
+    {
+        return;
+    }
+    if (_result.empty())
+    {
+        _pool->release(std::move(_result));
+        _result = _pool->acquire(size);
+    }
+    else
+    {
+        // Grow geometrically when the length isn't known in advance.
+        _result.reserve(std::max(size, _result.capacity() * 2));
+    }
 }
 
 void UrlAssetResponse::setCallbacks(CURL* curl)
@@ -176,24 +367,659 @@ void UrlAssetResponse::setCallbacks(CURL* curl)
     curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
 }
 
+CurlCache::CurlCache(bool shareConnections)
+    : share(curl_share_init())
+{
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    if (shareConnections)
+    {
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+}
+
+CurlCache::~CurlCache()
+{
+    // The share handle can't be cleaned up while easy handles are still using it.
+    for (auto& entry : _cache)
+    {
+        for (auto& curlObject : entry.second)
+        {
+            curl_easy_cleanup(curlObject->curl);
+        }
+    }
+    _cache.clear();
+    curl_share_cleanup(share);
+}
+
+void CurlCache::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+{
+    static_cast<CurlCache*>(userptr)->_shareMutexes[data].lock();
+}
+
+void CurlCache::unlockShare(CURL*, curl_lock_data data, void* userptr)
+{
+    static_cast<CurlCache*>(userptr)->_shareMutexes[data].unlock();
+}
+
+void CurlCache::initHandle(CurlObject* curlObject)
+{
+    curl_easy_setopt(curlObject->curl, CURLOPT_ERRORBUFFER, curlObject->errbuf);
+    curl_easy_setopt(curlObject->curl, CURLOPT_SHARE, share);
+}
+
+std::unique_ptr<CurlCache::CurlObject> CurlCache::get(const std::string& host)
+{
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        // Prefer a handle that last talked to this host; otherwise any idle handle will do, as the
+        // connections themselves are in the share handle.
+        auto itr = _cache.find(host);
+        if (itr == _cache.end() || itr->second.empty())
+        {
+            itr = std::find_if(_cache.begin(), _cache.end(),
+                               [](const auto& entry)
+                               {
+                                   return !entry.second.empty();
+                               });
+        }
+        if (itr != _cache.end())
+        {
+            std::unique_ptr<CurlObject> result = std::move(itr->second.back());
+            itr->second.pop_back();
+            result->host = host;
+            return result;
+        }
+    }
+    CURL *curl = curl_easy_init();
+    auto result = std::make_unique<CurlObject>(curl);
+    result->host = host;
+    initHandle(result.get());
+    return result;
+}
+
+void CurlCache::release(std::unique_ptr<CurlObject> curlObject)
+{
+    // Options like CURLOPT_CUSTOMREQUEST would otherwise leak into the next request that
+    // uses the handle. curl_easy_reset() keeps the live connections and caches.
+    curl_easy_reset(curlObject->curl);
+    initHandle(curlObject.get());
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    auto& idle = _cache[curlObject->host];
+    idle.push_back(std::move(curlObject));
+}
+
+HostConcurrency::HostConcurrency(long defaultLimit)
+    : _defaultLimit(defaultLimit)
+{
+}
+
+void HostConcurrency::setLimit(const std::string& host, long limit)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _limits[host] = limit;
+}
+
+void HostConcurrency::setDefaultLimit(long limit)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _defaultLimit = limit;
+}
+
+long HostConcurrency::limitLocked(const std::string& host) const
+{
+    if (host.empty())
+    {
+        return 0;
+    }
+    auto itr = _limits.find(host);
+    return itr == _limits.end() ? _defaultLimit : itr->second;
+}
+
+long HostConcurrency::getLimit(const std::string& host)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return limitLocked(host);
+}
+
+bool HostConcurrency::tryAcquire(const std::string& host, bool countWait)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    long limit = limitLocked(host);
+    long& active = _active[host];
+    if (limit > 0 && active >= limit)
+    {
+        if (countWait)
+        {
+            ++_waits[host];
+        }
+        return false;
+    }
+    ++active;
+    return true;
+}
+
+void HostConcurrency::release(const std::string& host)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_active[host];
+}
+
+uint64_t HostConcurrency::getWaits(const std::string& host)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto itr = _waits.find(host);
+    return itr == _waits.end() ? 0 : itr->second;
+}
+
+std::string vsgCs::getUrlHost(const std::string& url)
+{
+    std::string result;
+    CURLU* curlUrl = curl_url();
+    if (curl_url_set(curlUrl, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK)
+    {
+        char* host = nullptr;
+        if (curl_url_get(curlUrl, CURLUPART_HOST, &host, 0) == CURLUE_OK)
+        {
+            result = host;
+            curl_free(host);
+        }
+    }
+    curl_url_cleanup(curlUrl);
+    return result;
+}
+
+namespace
+{
+    using RequestPromise = CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>>;
+
+    uint64_t getTimeInfo(CURL* curl, CURLINFO info)
+    {
+        curl_off_t result = 0;
+        curl_easy_getinfo(curl, info, &result);
+        return result > 0 ? static_cast<uint64_t>(result) : 0;
+    }
+
+    // libcurl's times are cumulative from the start of the transfer; split them into phases.
+    void recordTelemetry(CURL* curl, NetworkTelemetry& telemetry, const std::string& host)
+    {
+        uint64_t nameLookup = getTimeInfo(curl, CURLINFO_NAMELOOKUP_TIME_T);
+        uint64_t connect = getTimeInfo(curl, CURLINFO_CONNECT_TIME_T);
+        uint64_t appConnect = getTimeInfo(curl, CURLINFO_APPCONNECT_TIME_T);
+        uint64_t startTransfer = getTimeInfo(curl, CURLINFO_STARTTRANSFER_TIME_T);
+        uint64_t total = getTimeInfo(curl, CURLINFO_TOTAL_TIME_T);
+        curl_off_t bytes = 0;
+        curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+        TransferTimes times;
+        // A reused connection reports 0 connect time.
+        times.dns = nameLookup;
+        times.connect = connect > nameLookup ? connect - nameLookup : 0;
+        times.tls = appConnect > connect ? appConnect - connect : 0;
+        uint64_t requestSent = std::max(connect, appConnect);
+        times.firstByte = startTransfer > requestSent ? startTransfer - requestSent : 0;
+        times.transfer = total > startTransfer ? total - startTransfer : 0;
+        times.total = total;
+        times.bytes = bytes > 0 ? static_cast<uint64_t>(bytes) : 0;
+        telemetry.record(host, times);
+    }
+
+    // Fill in the response from a finished easy handle and settle the promise. Shared by the
+    // blocking and curl multi code paths. telemetry may be null.
+    void finishRequest(CURL* curl, CURLcode responseCode, const char* errbuf,
+                       const std::shared_ptr<UrlAssetRequest>& request,
+                       std::unique_ptr<UrlAssetResponse> response,
+                       const RequestPromise& promise,
+                       NetworkTelemetry* telemetry, const std::string& host)
+    {
+        if (telemetry && !host.empty())
+        {
+            if (responseCode == CURLE_OK)
+            {
+                recordTelemetry(curl, *telemetry, host);
+            }
+            else
+            {
+                telemetry->recordError(host);
+            }
+        }
+        if (responseCode == CURLE_OK)
+        {
+            long httpResponseCode = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpResponseCode);
+            response->_statusCode = static_cast<uint16_t>(httpResponseCode);
+            // The response header callback also sets _contentType, so not sure that this is
+            // necessary...
+            char *ct = nullptr;
+            curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &ct);
+            if (ct)
+            {
+                response->_contentType = ct;
+            }
+            request->setResponse(std::move(response));
+            promise.resolve(request);
+        }
+        else
+        {
+            std::string curlMsg("curl: ");
+            curlMsg += errbuf[0] != '\0' ? errbuf : curl_easy_strerror(responseCode);
+            promise.reject(std::runtime_error(curlMsg));
+        }
+    }
+
+    void setPostOptions(CURL* curl, const std::string& verb, const std::vector<std::byte>& payload)
+    {
+        if (payload.size() > 1UL << 31)
+        {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(payload.size()));
+        }
+        else
+        {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload.size()));
+        }
+        curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, reinterpret_cast<const char*>(payload.data()));
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, verb.c_str());
+    }
+}
+
+namespace vsgCs
+{
+    // An event-driven transfer engine. One I/O thread owns a curl multi handle and runs all the
+    // transfers; the promises are resolved from there as the transfers complete, so any number of
+    // requests can be outstanding without tying up the AsyncSystem's worker threads.
+    //
+    // Queued requests are started newest generation first (see UrlAssetAccessor::tick()) and in
+    // FIFO order within a generation, so after a fast camera move the tiles that Cesium wants now
+    // aren't stuck behind requests for tiles that have left the view. Requests that have aged past
+    // options.requestAgingGenerations go to the front of the queue, oldest first, which bounds
+    // the time any request waits.
+
+    class CurlMultiEngine
+    {
+    public:
+        struct Transfer
+        {
+            std::string host;
+            uint64_t generation = 0;
+            std::unique_ptr<CurlCache::CurlObject> curl;
+            curl_slist* headerList = nullptr;
+            std::shared_ptr<UrlAssetRequest> request;
+            std::unique_ptr<UrlAssetResponse> response;
+            std::vector<std::byte> payload;
+            RequestPromise promise;
+            bool cancelled = false;
+        };
+
+        explicit CurlMultiEngine(UrlAssetAccessor* accessor);
+        ~CurlMultiEngine();
+        void submit(std::unique_ptr<Transfer> transfer);
+        // Cancel the requests for url, or all requests if url is empty.
+        void cancel(const std::string& url);
+    private:
+        struct QueueKey
+        {
+            uint64_t generation;
+            uint64_t sequence;
+            bool operator<(const QueueKey& rhs) const
+            {
+                if (generation != rhs.generation)
+                {
+                    return generation > rhs.generation;
+                }
+                return sequence < rhs.sequence;
+            }
+        };
+        void run();
+        void startTransfer(std::unique_ptr<Transfer> transfer);
+        void finishTransfer(CURL* curl, CURLcode result);
+        // Called with _mutex held
+        void takeStaleLocked(std::vector<std::unique_ptr<Transfer>>& stale);
+        void takeCancelledLocked(std::vector<std::unique_ptr<Transfer>>& cancelled);
+        void takeStartableLocked(std::vector<std::unique_ptr<Transfer>>& newTransfers);
+        void abortCancelled();
+        UrlAssetAccessor* _accessor;
+        CURLM* _multi;
+        std::mutex _mutex;
+        std::map<QueueKey, std::unique_ptr<Transfer>> _pending;
+        uint64_t _sequence = 0;
+        std::vector<std::string> _cancels;
+        bool _cancelAll = false;
+        bool _stop = false;
+        // Only touched by the I/O thread
+        std::unordered_map<CURL*, std::unique_ptr<Transfer>> _active;
+        std::thread _thread;
+    };
+}
+
+CurlMultiEngine::CurlMultiEngine(UrlAssetAccessor* accessor)
+    : _accessor(accessor), _multi(curl_multi_init())
+{
+    curl_multi_setopt(_multi, CURLMOPT_PIPELINING,
+                      accessor->options.useHttp2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    _thread = std::thread([this]()
+    {
+        run();
+    });
+}
+
+CurlMultiEngine::~CurlMultiEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    curl_multi_wakeup(_multi);
+    _thread.join();
+    curl_multi_cleanup(_multi);
+}
+
+void CurlMultiEngine::submit(std::unique_ptr<Transfer> transfer)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        QueueKey key{transfer->generation, _sequence++};
+        _pending.emplace(key, std::move(transfer));
+    }
+    curl_multi_wakeup(_multi);
+}
+
+void CurlMultiEngine::cancel(const std::string& url)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (url.empty())
+        {
+            _cancelAll = true;
+        }
+        else
+        {
+            _cancels.push_back(url);
+        }
+    }
+    curl_multi_wakeup(_multi);
+}
+
+void CurlMultiEngine::startTransfer(std::unique_ptr<Transfer> transfer)
+{
+    transfer->curl = _accessor->curlCache->get(transfer->host);
+    CURL* curl = transfer->curl->curl;
+    transfer->headerList = _accessor->setCommonOptions(curl, transfer->request->url(),
+                                                       transfer->request->headers());
+    if (transfer->request->method() != "GET")
+    {
+        setPostOptions(curl, transfer->request->method(), transfer->payload);
+    }
+    transfer->response->setCallbacks(curl);
+    if (_accessor->options.useHttp2)
+    {
+        // Wait for a multiplexed connection to the host rather than opening a new one.
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    }
+    curl_multi_add_handle(_multi, curl);
+    _active.emplace(curl, std::move(transfer));
+}
+
+void CurlMultiEngine::finishTransfer(CURL* curl, CURLcode result)
+{
+    auto itr = _active.find(curl);
+    if (itr == _active.end())
+    {
+        return;
+    }
+    std::unique_ptr<Transfer> transfer = std::move(itr->second);
+    _active.erase(itr);
+    curl_multi_remove_handle(_multi, curl);
+    curl_slist_free_all(transfer->headerList);
+    if (transfer->cancelled)
+    {
+        transfer->promise.reject(std::runtime_error("curl: request cancelled: "
+                                                    + transfer->request->url()));
+    }
+    else
+    {
+        finishRequest(curl, result, transfer->curl->errbuf, transfer->request,
+                      std::move(transfer->response), transfer->promise,
+                      _accessor->options.collectTelemetry ? &_accessor->telemetry : nullptr,
+                      transfer->host);
+    }
+    _accessor->curlCache->release(std::move(transfer->curl));
+    _accessor->hostConcurrency.release(transfer->host);
+}
+
+// Promises are settled outside of _mutex because their continuations may make new requests.
+
+void CurlMultiEngine::takeStaleLocked(std::vector<std::unique_ptr<Transfer>>& stale)
+{
+    uint64_t staleGenerations = _accessor->options.staleRequestGenerations;
+    uint64_t generation = _accessor->_generation.load();
+    if (staleGenerations == 0 || generation < staleGenerations)
+    {
+        return;
+    }
+    // The map is sorted by decreasing generation, so the stale requests are at the end.
+    auto first = _pending.lower_bound(QueueKey{generation - staleGenerations, UINT64_MAX});
+    for (auto itr = first; itr != _pending.end(); ++itr)
+    {
+        stale.push_back(std::move(itr->second));
+    }
+    _pending.erase(first, _pending.end());
+}
+
+void CurlMultiEngine::takeCancelledLocked(std::vector<std::unique_ptr<Transfer>>& cancelled)
+{
+    if (!_cancelAll && _cancels.empty())
+    {
+        return;
+    }
+    auto isCancelled = [this](const Transfer& transfer)
+    {
+        return _cancelAll
+            || std::find(_cancels.begin(), _cancels.end(), transfer.request->url()) != _cancels.end();
+    };
+    for (auto itr = _pending.begin(); itr != _pending.end();)
+    {
+        if (isCancelled(*itr->second))
+        {
+            cancelled.push_back(std::move(itr->second));
+            itr = _pending.erase(itr);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+    // In-flight transfers are aborted by the I/O thread after the lock is released.
+    for (auto& entry : _active)
+    {
+        if (isCancelled(*entry.second))
+        {
+            entry.second->cancelled = true;
+        }
+    }
+    _cancels.clear();
+    _cancelAll = false;
+}
+
+void CurlMultiEngine::takeStartableLocked(std::vector<std::unique_ptr<Transfer>>& newTransfers)
+{
+    auto hasRoom = [this, &newTransfers]()
+    {
+        return static_cast<long>(_active.size() + newTransfers.size())
+            < _accessor->options.maxActiveTransfers;
+    };
+    // Requests whose host is at its concurrency limit are skipped over.
+    auto tryStart = [this, &newTransfers](std::map<QueueKey, std::unique_ptr<Transfer>>::iterator itr)
+    {
+        if (_accessor->hostConcurrency.tryAcquire(itr->second->host))
+        {
+            newTransfers.push_back(std::move(itr->second));
+            _pending.erase(itr);
+        }
+    };
+    uint64_t agingGenerations = _accessor->options.requestAgingGenerations;
+    uint64_t generation = _accessor->_generation.load();
+    if (agingGenerations > 0 && generation >= agingGenerations)
+    {
+        // The aged requests are at the end of the map. Sequence numbers are in submission order.
+        std::vector<std::map<QueueKey, std::unique_ptr<Transfer>>::iterator> aged;
+        for (auto itr = _pending.lower_bound(QueueKey{generation - agingGenerations + 1, UINT64_MAX});
+             itr != _pending.end();
+             ++itr)
+        {
+            aged.push_back(itr);
+        }
+        std::sort(aged.begin(), aged.end(),
+                  [](const auto& lhs, const auto& rhs)
+                  {
+                      return lhs->first.sequence < rhs->first.sequence;
+                  });
+        for (auto itr : aged)
+        {
+            if (!hasRoom())
+            {
+                return;
+            }
+            tryStart(itr);
+        }
+    }
+    for (auto itr = _pending.begin(); hasRoom() && itr != _pending.end();)
+    {
+        auto next = std::next(itr);
+        tryStart(itr);
+        itr = next;
+    }
+}
+
+void CurlMultiEngine::abortCancelled()
+{
+    std::vector<CURL*> aborted;
+    for (auto& entry : _active)
+    {
+        if (entry.second->cancelled)
+        {
+            aborted.push_back(entry.first);
+        }
+    }
+    for (CURL* curl : aborted)
+    {
+        finishTransfer(curl, CURLE_ABORTED_BY_CALLBACK);
+    }
+}
+
+void CurlMultiEngine::run()
+{
+    std::vector<std::unique_ptr<Transfer>> newTransfers;
+    std::vector<std::unique_ptr<Transfer>> cancelled;
+    std::vector<std::unique_ptr<Transfer>> stale;
+    bool stop = false;
+    while (!stop)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stop)
+            {
+                // Shutting down; nothing will ever complete these requests.
+                _cancelAll = true;
+                stop = true;
+            }
+            takeCancelledLocked(cancelled);
+            takeStaleLocked(stale);
+            if (!stop)
+            {
+                takeStartableLocked(newTransfers);
+            }
+        }
+        for (auto& transfer : cancelled)
+        {
+            transfer->promise.reject(std::runtime_error("curl: request cancelled: "
+                                                        + transfer->request->url()));
+        }
+        cancelled.clear();
+        for (auto& transfer : stale)
+        {
+            transfer->promise.reject(std::runtime_error("curl: stale request dropped: "
+                                                        + transfer->request->url()));
+        }
+        stale.clear();
+        abortCancelled();
+        if (stop)
+        {
+            break;
+        }
+        for (auto& transfer : newTransfers)
+        {
+            startTransfer(std::move(transfer));
+        }
+        newTransfers.clear();
+        int stillRunning = 0;
+        curl_multi_perform(_multi, &stillRunning);
+        int msgsInQueue = 0;
+        bool finished = false;
+        while (CURLMsg* msg = curl_multi_info_read(_multi, &msgsInQueue))
+        {
+            if (msg->msg == CURLMSG_DONE)
+            {
+                finishTransfer(msg->easy_handle, msg->data.result);
+                finished = true;
+            }
+        }
+        // Finished transfers free up slots for queued requests, so don't wait.
+        if (!finished)
+        {
+            VSGCS_ZONESCOPEDN("curl multi poll");
+            curl_multi_poll(_multi, nullptr, 0, 1000, nullptr);
+        }
+    }
+}
+
 UrlAssetAccessor::UrlAssetAccessor(bool doGlobalCurlInit)
-    :  userAgent("Mozilla/5.0 vsgCs Cesium for VSG"), curlGlobalInitCalled(false)
+    : UrlAssetAccessor(UrlAssetAccessorOptions{.doGlobalCurlInit = doGlobalCurlInit})
+{
+}
+
+UrlAssetAccessor::UrlAssetAccessor(const UrlAssetAccessorOptions& in_options)
+    :  hostConcurrency(in_options.defaultHostConcurrencyLimit),
+       userAgent("Mozilla/5.0 vsgCs Cesium for VSG"), options(in_options), curlGlobalInitCalled(false)
 {
     // XXX Do we need to worry about the thread safety problems with
     // this?
-    if (doGlobalCurlInit)
+    if (options.doGlobalCurlInit)
     {
         curl_global_init(CURL_GLOBAL_ALL);
         curlGlobalInitCalled = true;
     }
+    curlCache = std::make_unique<CurlCache>(options.useCurlMulti);
     _cesiumHeaders.emplace_back("X-Cesium-Client:vsgCs");
     _cesiumHeaders.emplace_back("X-Cesium-Client-Version:" + Version::get());
     _cesiumHeaders.emplace_back("X-Cesium-Client-Engine:" + Version::getEngineVersion());
     _cesiumHeaders.emplace_back("X-Cesium-Client-OS:" + Version::getOsVersion());
+    _bufferPool = std::make_shared<ByteBufferPool>(options.bufferPoolSize, options.maxPooledBufferSize);
+    for (const auto& [host, limit] : options.hostConcurrencyLimits)
+    {
+        hostConcurrency.setLimit(host, limit);
+    }
+    if (options.useCurlMulti)
+    {
+        _multiEngine = std::make_unique<CurlMultiEngine>(this);
+    }
+    if (options.adaptiveConcurrency)
+    {
+        setAdaptiveConcurrency(*options.adaptiveConcurrency);
+    }
 }
 
 UrlAssetAccessor::~UrlAssetAccessor()
 {
+    // Stop the I/O thread before the curl handle cache goes away, and clean up the cached handles
+    // before the global cleanup.
+    _multiEngine.reset();
+    curlCache.reset();
+    if (!options.telemetryFile.empty() && !telemetry.writeJson(options.telemetryFile))
+    {
+        vsg::warn("UrlAssetAccessor: can't write telemetry to ", options.telemetryFile);
+    }
     if (curlGlobalInitCalled)
     {
         curl_global_cleanup();
@@ -209,6 +1035,10 @@ UrlAssetAccessor::setCommonOptions(CURL* curl,
     curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent.c_str());
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    if (options.useHttp2)
+    {
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    }
     // curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_slist* list = nullptr;
     for (const auto& header : headers)
@@ -232,43 +1062,120 @@ CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
 UrlAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem,
                       const std::string& url,
                       const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+{
+    if (!options.coalesceRequests)
+    {
+        return getUncoalesced(asyncSystem, url, headers);
+    }
+    // Identical requests that are in flight share one transfer and its response.
+    std::string key = url;
+    auto sortedHeaders = headers;
+    std::sort(sortedHeaders.begin(), sortedHeaders.end());
+    for (const auto& header : sortedHeaders)
+    {
+        key.append("\n").append(header.first).append(":").append(header.second);
+    }
+    std::unique_lock<std::mutex> lock(_inFlightMutex);
+    auto itr = _inFlight.find(key);
+    if (itr != _inFlight.end())
+    {
+        return itr->second.thenImmediately(
+            [](const std::shared_ptr<CesiumAsync::IAssetRequest>& request)
+            {
+                return request;
+            });
+    }
+    auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+    auto sharedFuture = promise.getFuture().share();
+    _inFlight.emplace(key, sharedFuture);
+    lock.unlock();
+    getUncoalesced(asyncSystem, url, headers)
+        .thenImmediately([this, key, promise](std::shared_ptr<CesiumAsync::IAssetRequest>&& request)
+        {
+            removeInFlight(key);
+            promise.resolve(std::move(request));
+        })
+        .catchImmediately([this, key, promise](std::exception&& e)
+        {
+            removeInFlight(key);
+            promise.reject(std::runtime_error(e.what()));
+        });
+    return sharedFuture.thenImmediately(
+        [](const std::shared_ptr<CesiumAsync::IAssetRequest>& request)
+        {
+            return request;
+        });
+}
+
+void UrlAssetAccessor::removeInFlight(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(_inFlightMutex);
+    _inFlight.erase(key);
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+UrlAssetAccessor::getUncoalesced(const CesiumAsync::AsyncSystem& asyncSystem,
+                                 const std::string& url,
+                                 const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
 {
     return asyncSystem.createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>(
         [&](const auto& promise)
         {
             std::shared_ptr<UrlAssetRequest> request
                 = std::make_shared<UrlAssetRequest>("GET", url, headers);
-            asyncSystem.runInWorkerThread([promise, request, this]()
+            std::string localPath = options.mapLocalFiles ? getFileUrlPath(url) : std::string();
+            if (!localPath.empty())
             {
-                VSGCS_ZONESCOPEDN("UrlAssetAccessor::get inner");
-                CurlHandle curl(this);
-                curl_slist* list = setCommonOptions(curl(), request->url(), request->headers());
-                std::unique_ptr<UrlAssetResponse> response = std::make_unique<UrlAssetResponse>();
-                response->setCallbacks(curl());
-                CURLcode responseCode = curl_easy_perform(curl());
-                curl_slist_free_all(list);
-                if (responseCode == 0)
+                asyncSystem.runInThreadPool(getIOThreadPool(),
+                                            instrumentTask(TaskCategory::Fetch,
+                                                           [promise, request, localPath]()
                 {
-                    long httpResponseCode = 0;
-                    curl_easy_getinfo(curl(), CURLINFO_RESPONSE_CODE, &httpResponseCode);
-                    response->_statusCode = static_cast<uint16_t>(httpResponseCode);
-                    // The response header callback also sets _contentType, so not sure that this is
-                    // necessary...
-                    char *ct = nullptr;
-                    curl_easy_getinfo(curl(), CURLINFO_CONTENT_TYPE, &ct);
-                    if (ct)
+                    VSGCS_ZONESCOPEDN("UrlAssetAccessor::get mapped file");
+                    try
                     {
-                        response->_contentType = ct;
+                        request->setResponse(
+                            std::make_unique<MappedFileResponse>(MappedFile::open(localPath)));
+                        promise.resolve(request);
                     }
-                    request->setResponse(std::move(response));
-                    promise.resolve(request);
-                }
-                else
+                    catch (const std::exception& e)
+                    {
+                        promise.reject(std::runtime_error(e.what()));
+                    }
+                }));
+                return;
+            }
+            if (_multiEngine)
+            {
+                _multiEngine->submit(std::make_unique<CurlMultiEngine::Transfer>(
+                                         CurlMultiEngine::Transfer{
+                                             .host = getUrlHost(url),
+                                             .generation = _generation.load(),
+                                             .request = request,
+                                             .response = std::make_unique<UrlAssetResponse>(_bufferPool),
+                                             .promise = promise}));
+                return;
+            }
+            std::string host = getUrlHost(url);
+            startWhenFree(host, [asyncSystem, promise, request, host, this]()
+            {
+                asyncSystem.runInThreadPool(getIOThreadPool(),
+                                            instrumentTask(TaskCategory::Fetch, [promise, request, host, this]()
                 {
-                    std::string curlMsg("curl: ");
-                    curlMsg += curl.getErrBuf();
-                    promise.reject(std::runtime_error(curlMsg));
-                }
+                    VSGCS_ZONESCOPEDN("UrlAssetAccessor::get inner");
+                    // The host's slot was claimed by startWhenFree().
+                    auto slot = gsl::finally([this, &host]()
+                    {
+                        releaseHost(host);
+                    });
+                    CurlHandle curl(this, host);
+                    curl_slist* list = setCommonOptions(curl(), request->url(), request->headers());
+                    auto response = std::make_unique<UrlAssetResponse>(_bufferPool);
+                    response->setCallbacks(curl());
+                    CURLcode responseCode = curl_easy_perform(curl());
+                    curl_slist_free_all(list);
+                    finishRequest(curl(), responseCode, curl.getErrBuf(), request, std::move(response),
+                                  promise, options.collectTelemetry ? &telemetry : nullptr, host);
+                }));
             });
         });
 }
@@ -286,53 +1193,158 @@ UrlAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem,
         [&](const auto& promise)
         {
             auto request = std::make_shared<UrlAssetRequest>(verb, url, headers);
+            if (_multiEngine)
+            {
+                _multiEngine->submit(std::make_unique<CurlMultiEngine::Transfer>(
+                                         CurlMultiEngine::Transfer{
+                                             .host = getUrlHost(url),
+                                             .generation = _generation.load(),
+                                             .request = request,
+                                             .response = std::make_unique<UrlAssetResponse>(_bufferPool),
+                                             .payload = std::vector<std::byte>(contentPayload.begin(),
+                                                                               contentPayload.end()),
+                                             .promise = promise}));
+                return;
+            }
             auto payloadCopy
                 = std::make_shared<std::vector<std::byte>>(contentPayload.begin(), contentPayload.end());
-            asyncSystem.runInWorkerThread([promise, request, payloadCopy, this]()
+            std::string host = getUrlHost(url);
+            startWhenFree(host, [asyncSystem, promise, request, payloadCopy, host, this]()
             {
-                VSGCS_ZONESCOPEDN("UrlAssetAccessor::request inner");
-                CurlHandle curl(this);
-
-                curl_slist* list = setCommonOptions(curl(), request->url(), request->headers());
-                if (payloadCopy->size() > 1UL << 31)
+                asyncSystem.runInThreadPool(getIOThreadPool(),
+                                            instrumentTask(TaskCategory::Fetch,
+                                                           [promise, request, payloadCopy, host, this]()
                 {
-                    curl_easy_setopt(curl(), CURLOPT_POSTFIELDSIZE_LARGE, payloadCopy->size());
-                }
-                else
-                {
-                    curl_easy_setopt(curl(), CURLOPT_POSTFIELDSIZE, payloadCopy->size());
-                }
-                curl_easy_setopt(curl(), CURLOPT_COPYPOSTFIELDS,
-                                 reinterpret_cast<const char*>(payloadCopy->data()));
-                curl_easy_setopt(curl(), CURLOPT_CUSTOMREQUEST, request->method().c_str());
-                std::unique_ptr<UrlAssetResponse> response = std::make_unique<UrlAssetResponse>();
-                response->setCallbacks(curl());
-                CURLcode responseCode = curl_easy_perform(curl());
-                curl_slist_free_all(list);
-                if (responseCode == 0)
-                {
-                    long httpResponseCode = 0;
-                    curl_easy_getinfo(curl(), CURLINFO_RESPONSE_CODE, &httpResponseCode);
-                    response->_statusCode = static_cast<uint16_t>(httpResponseCode);
-                    char *ct = nullptr;
-                    curl_easy_getinfo(curl(), CURLINFO_CONTENT_TYPE, &ct);
-                    if (ct)
+                    VSGCS_ZONESCOPEDN("UrlAssetAccessor::request inner");
+                    // The host's slot was claimed by startWhenFree().
+                    auto slot = gsl::finally([this, &host]()
                     {
-                        response->_contentType = ct;
-                    }
-                    request->setResponse(std::move(response));
-                    promise.resolve(request);
-                }
-                else
-                {
-                    std::string curlMsg("curl: ");
-                    curlMsg += curl.getErrBuf();
-                    promise.reject(std::runtime_error(curlMsg));
-                }
+                        releaseHost(host);
+                    });
+                    CurlHandle curl(this, host);
+
+                    curl_slist* list = setCommonOptions(curl(), request->url(), request->headers());
+                    setPostOptions(curl(), request->method(), *payloadCopy);
+                    auto response = std::make_unique<UrlAssetResponse>(_bufferPool);
+                    response->setCallbacks(curl());
+                    CURLcode responseCode = curl_easy_perform(curl());
+                    curl_slist_free_all(list);
+                    finishRequest(curl(), responseCode, curl.getErrBuf(), request, std::move(response),
+                                  promise, options.collectTelemetry ? &telemetry : nullptr, host);
+                }));
             });
         });
 }
 
+void UrlAssetAccessor::startWhenFree(const std::string& host, std::function<void()> start)
+{
+    {
+        std::lock_guard<std::mutex> lock(_hostQueueMutex);
+        auto itr = _hostQueues.find(host);
+        // Queued requests go first.
+        if ((itr != _hostQueues.end() && !itr->second.empty()) || !hostConcurrency.tryAcquire(host))
+        {
+            _hostQueues[host].push_back(std::move(start));
+            return;
+        }
+    }
+    start();
+}
+
+void UrlAssetAccessor::takeQueuedLocked(const std::string& host,
+                                        std::vector<std::function<void()>>& startable)
+{
+    auto itr = _hostQueues.find(host);
+    if (itr == _hostQueues.end())
+    {
+        return;
+    }
+    auto& queue = itr->second;
+    while (!queue.empty() && hostConcurrency.tryAcquire(host, false))
+    {
+        startable.push_back(std::move(queue.front()));
+        queue.pop_front();
+    }
+    if (queue.empty())
+    {
+        _hostQueues.erase(itr);
+    }
+}
+
+void UrlAssetAccessor::releaseHost(const std::string& host)
+{
+    std::vector<std::function<void()>> startable;
+    {
+        std::lock_guard<std::mutex> lock(_hostQueueMutex);
+        hostConcurrency.release(host);
+        takeQueuedLocked(host, startable);
+    }
+    for (auto& start : startable)
+    {
+        start();
+    }
+}
+
 void UrlAssetAccessor::tick() noexcept
 {
+    // Cesium ticks the accessor in every tileset update, so requests made since the last tick are
+    // the most relevant to the current view.
+    ++_generation;
+    {
+        std::lock_guard<std::mutex> lock(_adaptiveMutex);
+        if (_adaptiveConcurrency)
+        {
+            _adaptiveConcurrency->update(std::chrono::steady_clock::now(), telemetry, hostConcurrency);
+        }
+    }
+    // Start the queued requests of hosts whose limits were raised.
+    std::vector<std::function<void()>> startable;
+    {
+        std::lock_guard<std::mutex> lock(_hostQueueMutex);
+        std::vector<std::string> hosts;
+        for (const auto& entry : _hostQueues)
+        {
+            hosts.push_back(entry.first);
+        }
+        for (const auto& host : hosts)
+        {
+            takeQueuedLocked(host, startable);
+        }
+    }
+    for (auto& start : startable)
+    {
+        start();
+    }
+}
+
+void UrlAssetAccessor::cancel(const std::string& url)
+{
+    if (_multiEngine && !url.empty())
+    {
+        _multiEngine->cancel(url);
+    }
+}
+
+void UrlAssetAccessor::cancelAll()
+{
+    if (_multiEngine)
+    {
+        _multiEngine->cancel({});
+    }
+}
+
+void UrlAssetAccessor::setHostConcurrencyLimit(const std::string& host, long limit)
+{
+    hostConcurrency.setLimit(host, limit);
+}
+
+void UrlAssetAccessor::setAdaptiveConcurrency(const AdaptiveConcurrencyOptions& adaptiveOptions)
+{
+    if (!options.collectTelemetry)
+    {
+        vsg::warn("UrlAssetAccessor: adaptive concurrency needs telemetry; not enabling it.");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_adaptiveMutex);
+    _adaptiveConcurrency = std::make_unique<AdaptiveHostConcurrency>(adaptiveOptions);
 }
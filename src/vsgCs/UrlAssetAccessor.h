@@ -25,25 +25,40 @@ SOFTWARE.
 #pragma once
 
 #include "vsgCs/Export.h"
+#include "ConcurrencyController.h"
+#include "NetworkTelemetry.h"
 
 #include "CesiumAsync/AsyncSystem.h"
 #include "CesiumAsync/IAssetAccessor.h"
 
 #include <curl/curl.h>
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
 #include <mutex>
-#include <forward_list>
+#include <optional>
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <cstddef>
+#include <cstdint>
 
 namespace vsgCs
 {
     // A cache that permits reuse of CURL handles. This is extremely important for performance
     // because libcurl will keep existing connections open if a curl handle is not destroyed
     // ("cleaned up"). Our performance went from 180ms per get request to 60ms with this change.
-    
+    //
+    // Idle handles are kept per host, and all handles share DNS results and TLS sessions through a
+    // curl share handle, so a request to a host will usually find a warm connection or at least
+    // resume a TLS session. libcurl doesn't support sharing the connection pool between transfers
+    // running concurrently in different threads, so that is only shared when all the handles are
+    // driven by the one curl multi thread.
+
     struct CurlCache
     {
         struct CurlObject
@@ -58,35 +73,139 @@ namespace vsgCs
             }
             CURL* curl;
             char errbuf[CURL_ERROR_SIZE];
+            // The host of the last request made with this handle
+            std::string host;
         };
-        std::mutex cacheMutex;
-        std::forward_list<std::unique_ptr<CurlObject>> cache;
-        std::unique_ptr<CurlObject> get()
-        {
-            std::lock_guard<std::mutex> lock(cacheMutex);
-            if (!cache.empty())
-            {
-                std::unique_ptr<CurlObject> result = std::move(cache.front());
-                cache.pop_front();
-                return result;
-            }
-            CURL *curl = curl_easy_init();
-            auto result = std::make_unique<CurlObject>(curl);
-            curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, result->errbuf);
-            return result;
-        }
-        void release(std::unique_ptr<CurlObject> curlObject)
-        {
-            std::lock_guard<std::mutex> lock(cacheMutex);
-            cache.emplace_front(std::move(curlObject));
-        }
+        explicit CurlCache(bool shareConnections = false);
+        ~CurlCache();
+        CurlCache(const CurlCache&) = delete;
+        CurlCache& operator=(const CurlCache&) = delete;
+        std::unique_ptr<CurlObject> get(const std::string& host = {});
+        void release(std::unique_ptr<CurlObject> curlObject);
+        CURLSH* share;
+    private:
+        static void lockShare(CURL* curl, curl_lock_data data, curl_lock_access access, void* userptr);
+        static void unlockShare(CURL* curl, curl_lock_data data, void* userptr);
+        void initHandle(CurlObject* curlObject);
+        std::mutex _cacheMutex;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<CurlObject>>> _cache;
+        std::mutex _shareMutexes[CURL_LOCK_DATA_LAST];
+    };
+
+    // Limits on the number of simultaneous requests to each host. A limit of 0 means no limit.
+
+    class HostConcurrency
+    {
+    public:
+        explicit HostConcurrency(long defaultLimit = 0);
+        void setLimit(const std::string& host, long limit);
+        void setDefaultLimit(long limit);
+        long getLimit(const std::string& host);
+        // Claim a request slot for host if one is free. countWait is false when retrying a
+        // request that was already counted as waiting.
+        bool tryAcquire(const std::string& host, bool countWait = true);
+        void release(const std::string& host);
+        // Running count of the requests to host that found no free slot
+        uint64_t getWaits(const std::string& host);
+    private:
+        long limitLocked(const std::string& host) const;
+        std::mutex _mutex;
+        long _defaultLimit;
+        std::unordered_map<std::string, long> _limits;
+        std::unordered_map<std::string, long> _active;
+        std::unordered_map<std::string, uint64_t> _waits;
+    };
+
+    // Return the host name part of a URL, or the empty string for URLs without a host
+    // (e.g. file:).
+    std::string getUrlHost(const std::string& url);
+
+    struct UrlAssetAccessorOptions
+    {
+        bool doGlobalCurlInit = true;
+        /**
+         * @brief Perform transfers on a single I/O thread that drives a curl multi handle, instead
+         * of blocking a worker thread in curl_easy_perform() for each request.
+         */
+        bool useCurlMulti = false;
+        /**
+         * @brief In curl multi mode, the maximum number of transfers that are active at
+         * once. Further requests wait in a queue.
+         */
+        long maxActiveTransfers = 256;
+        /**
+         * @brief Negotiate HTTP/2 with servers that support it, and multiplex requests to a host
+         * over one connection.
+         */
+        bool useHttp2 = true;
+        /**
+         * @brief Default limit on the number of simultaneous requests to one host; 0 means no
+         * limit. Requests over the limit wait in a queue of their host, without holding an I/O
+         * thread, so a slow host doesn't hold up the others.
+         */
+        long defaultHostConcurrencyLimit = 0;
+        /**
+         * @brief Per-host limits on simultaneous requests, overriding the default.
+         */
+        std::map<std::string, long> hostConcurrencyLimits;
+        /**
+         * @brief In curl multi mode, reject queued requests that were made more than this many
+         * ticks ago; 0 (the default) never drops requests.
+         *
+         * Cesium treats a failed request as a permanently failed tile, so dropping is only
+         * appropriate when the view moves on and doesn't come back, e.g. flight playback.
+         */
+        uint64_t staleRequestGenerations = 0;
+        /**
+         * @brief In curl multi mode, queued requests that were made this many ticks ago are started
+         * before newer ones, oldest first, so that a camera that never stops moving can't starve
+         * them; 0 disables aging.
+         */
+        uint64_t requestAgingGenerations = 30;
+        /**
+         * @brief Serve GET requests for file: URLs from memory-mapped files instead of going
+         * through libcurl.
+         */
+        bool mapLocalFiles = true;
+        /**
+         * @brief Attach a GET request to an identical (same URL and headers) request that is
+         * already in flight, instead of making another transfer.
+         */
+        bool coalesceRequests = true;
+        /**
+         * @brief Record the timing phases and size of every transfer in the accessor's
+         * telemetry.
+         */
+        bool collectTelemetry = true;
+        /**
+         * @brief If not empty, write the telemetry as JSON to this file when the accessor is
+         * destroyed.
+         */
+        std::string telemetryFile;
+        /**
+         * @brief Total size of the response buffers kept for reuse.
+         */
+        size_t bufferPoolSize = 64 * 1024 * 1024;
+        /**
+         * @brief Buffers larger than this aren't kept for reuse.
+         */
+        size_t maxPooledBufferSize = 16 * 1024 * 1024;
+        /**
+         * @brief Adapt the concurrency limit of each host to its measured throughput and latency
+         * (see AdaptiveHostConcurrency). Needs collectTelemetry.
+         */
+        std::optional<AdaptiveConcurrencyOptions> adaptiveConcurrency;
     };
 
+    class ByteBufferPool;
+    class CurlMultiEngine;
+
     // Simple implementation of AssetAcessor that can make network and local requests
     class VSGCS_EXPORT UrlAssetAccessor
         : public CesiumAsync::IAssetAccessor {
     public:
         explicit UrlAssetAccessor(bool doGlobalCurlInit = true);
+        explicit UrlAssetAccessor(const UrlAssetAccessorOptions& options);
         ~UrlAssetAccessor() override;
 
         CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
@@ -104,14 +223,60 @@ namespace vsgCs
                 const std::span<const std::byte>& contentPayload) override;
 
         void tick() noexcept override;
-        CurlCache curlCache;
+        /**
+         * @brief Set the maximum number of simultaneous requests to host. 0 removes the limit.
+         */
+        void setHostConcurrencyLimit(const std::string& host, long limit);
+        /**
+         * @brief Adapt the concurrency limits of the hosts from now on; see
+         * UrlAssetAccessorOptions::adaptiveConcurrency. The limits are updated in tick().
+         */
+        void setAdaptiveConcurrency(const AdaptiveConcurrencyOptions& adaptiveOptions);
+        /**
+         * @brief In curl multi mode, cancel queued and in-flight requests for url. Their futures
+         * are rejected.
+         */
+        void cancel(const std::string& url);
+        /**
+         * @brief In curl multi mode, cancel all queued and in-flight requests, e.g. before
+         * destroying tilesets at exit so that their destruction doesn't wait on the network.
+         */
+        void cancelAll();
+        // Created after, and destroyed before, the global curl initialization.
+        std::unique_ptr<CurlCache> curlCache;
+        HostConcurrency hostConcurrency;
+        NetworkTelemetry telemetry;
         std::string userAgent;
+        const UrlAssetAccessorOptions options;
     private:
+        friend class CurlMultiEngine;
+        CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+            getUncoalesced(const CesiumAsync::AsyncSystem& asyncSystem,
+                           const std::string& url,
+                           const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers);
+        void removeInFlight(const std::string& key);
+        // Without the multi engine, a request that finds no free slot for its host waits in a
+        // queue of the host, not in an I/O thread, and is started when a slot is released.
+        void startWhenFree(const std::string& host, std::function<void()> start);
+        void releaseHost(const std::string& host);
+        void takeQueuedLocked(const std::string& host, std::vector<std::function<void()>>& startable);
         curl_slist* setCommonOptions(CURL* curl,
                                      const std::string& url,
                                      const CesiumAsync::HttpHeaders& headers);
         std::vector<std::string> _cesiumHeaders;
         bool curlGlobalInitCalled;
+        std::shared_ptr<ByteBufferPool> _bufferPool;
+        std::unique_ptr<CurlMultiEngine> _multiEngine;
+        std::mutex _adaptiveMutex;
+        std::unique_ptr<AdaptiveHostConcurrency> _adaptiveConcurrency;
+        // Incremented by tick(); requests of the newest generation are started first.
+        std::atomic<uint64_t> _generation{0};
+        std::mutex _hostQueueMutex;
+        std::unordered_map<std::string, std::deque<std::function<void()>>> _hostQueues;
+        std::mutex _inFlightMutex;
+        std::unordered_map<std::string,
+                           CesiumAsync::SharedFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>>
+            _inFlight;
     };
 
     // RAII wrapper for the CurlCache.
@@ -119,16 +284,16 @@ namespace vsgCs
     class CurlHandle
     {
     public:
-        explicit CurlHandle(UrlAssetAccessor* in_accessor)
+        explicit CurlHandle(UrlAssetAccessor* in_accessor, const std::string& host = {})
             : _accessor(in_accessor)
 
         {
-            _curl = _accessor->curlCache.get();
+            _curl = _accessor->curlCache->get(host);
         }
 
         ~CurlHandle()
         {
-            _accessor->curlCache.release(std::move(_curl));
+            _accessor->curlCache->release(std::move(_curl));
         }
 
         CURL* operator()() const
@@ -0,0 +1,224 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#include "WorkStealingTaskProcessor.h"
+#include "TaskStatistics.h"
+#include "Tracing.h"
+
+#include <algorithm>
+
+using namespace vsgCs;
+
+namespace
+{
+    // The processor and deque index of the current worker thread, if it is one.
+    thread_local const WorkStealingTaskProcessor* currentProcessor = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+namespace
+{
+    struct QueuedTask
+    {
+        std::function<void()> f;
+        TaskStatistics::clock::time_point queueTime;
+    };
+}
+
+// A ring buffer of tasks. The owning worker pushes and pops at the back; thieves take from the
+// front. Each operation holds the lock only long enough to move one std::function.
+class WorkStealingTaskProcessor::TaskDeque
+{
+public:
+    TaskDeque()
+        : _ring(64)
+    {
+    }
+
+    void pushBack(QueuedTask&& task)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count == _ring.size())
+        {
+            grow();
+        }
+        _ring[(_head + _count) % _ring.size()] = std::move(task);
+        ++_count;
+    }
+
+    bool popBack(QueuedTask& task)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count == 0)
+        {
+            return false;
+        }
+        --_count;
+        task = std::move(_ring[(_head + _count) % _ring.size()]);
+        return true;
+    }
+
+    bool popFront(QueuedTask& task)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count == 0)
+        {
+            return false;
+        }
+        task = std::move(_ring[_head]);
+        _head = (_head + 1) % _ring.size();
+        --_count;
+        return true;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& task : _ring)
+        {
+            task.f = nullptr;
+        }
+        _head = 0;
+        _count = 0;
+    }
+private:
+    void grow()
+    {
+        std::vector<QueuedTask> ring(_ring.size() * 2);
+        for (size_t i = 0; i < _count; ++i)
+        {
+            ring[i] = std::move(_ring[(_head + i) % _ring.size()]);
+        }
+        _ring = std::move(ring);
+        _head = 0;
+    }
+    std::mutex _mutex;
+    std::vector<QueuedTask> _ring;
+    size_t _head = 0;
+    size_t _count = 0;
+};
+
+WorkStealingTaskProcessor::WorkStealingTaskProcessor(uint32_t numThreads)
+{
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        _deques.push_back(std::make_unique<TaskDeque>());
+    }
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        _threads.emplace_back([this, i]() { run(i); });
+    }
+}
+
+WorkStealingTaskProcessor::~WorkStealingTaskProcessor()
+{
+    stop();
+}
+
+void WorkStealingTaskProcessor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
+    }
+    _sleepCond.notify_all();
+    for (auto& thread : _threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    for (auto& deque : _deques)
+    {
+        deque->clear();
+    }
+}
+
+void WorkStealingTaskProcessor::startTask(std::function<void()> f)
+{
+    size_t index = currentProcessor == this
+        ? currentIndex
+        : _nextDeque.fetch_add(1, std::memory_order_relaxed) % _deques.size();
+    // Counted before the push so that _pending never underflows. It pairs with a sleeping
+    // worker incrementing _sleepers before checking _pending: one of the two sees the other's
+    // update.
+    _pending.fetch_add(1);
+    getTaskStatistics().taskQueued(TaskCategory::Parse);
+    _deques[index]->pushBack(QueuedTask{std::move(f), TaskStatistics::clock::now()});
+    if (_sleepers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _sleepCond.notify_one();
+    }
+}
+
+bool WorkStealingTaskProcessor::tryRunTask(size_t index)
+{
+    QueuedTask task;
+    bool found = _deques[index]->popBack(task);
+    for (size_t i = 1; !found && i < _deques.size(); ++i)
+    {
+        found = _deques[(index + i) % _deques.size()]->popFront(task);
+    }
+    if (!found)
+    {
+        return false;
+    }
+    _pending.fetch_sub(1);
+    auto& statistics = getTaskStatistics();
+    auto start = TaskStatistics::clock::now();
+    statistics.taskStarted(TaskCategory::Parse, task.queueTime, start);
+    task.f();
+    statistics.taskFinished(TaskCategory::Parse, start, TaskStatistics::clock::now());
+    return true;
+}
+
+void WorkStealingTaskProcessor::run(size_t index)
+{
+#ifdef TRACY_ENABLE
+    tracy::SetThreadName("vsgCs worker");
+#endif
+    currentProcessor = this;
+    currentIndex = index;
+    while (!_stop)
+    {
+        if (tryRunTask(index))
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepers.fetch_add(1);
+        _sleepCond.wait(lock,
+                        [this]()
+                        {
+                            return _stop || _pending.load() > 0;
+                        });
+        _sleepers.fetch_sub(1);
+    }
+}
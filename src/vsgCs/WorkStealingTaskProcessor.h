@@ -0,0 +1,84 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Timothy Moore
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+</editor-fold> */
+
+#pragma once
+
+#include "vsgCs/Export.h"
+
+#include <CesiumAsync/ITaskProcessor.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vsgCs
+{
+    /**
+     * @brief A Cesium ITaskProcessor with a deque of tasks per worker thread and work stealing.
+     *
+     * A task started from a worker thread is pushed on that worker's deque, and the worker runs
+     * its own tasks newest first, which keeps the continuations of a tile load on the core that
+     * has its data in cache. Tasks started from other threads are spread round-robin over the
+     * workers. An idle worker steals the oldest tasks from the other workers before going to
+     * sleep.
+     *
+     * Tasks are stored by value in ring buffers that only grow, so starting a task doesn't
+     * allocate beyond what std::function itself needs.
+     */
+    class VSGCS_EXPORT WorkStealingTaskProcessor : public CesiumAsync::ITaskProcessor
+    {
+    public:
+        /**
+         * @param numThreads number of worker threads; 0 uses std::thread::hardware_concurrency().
+         */
+        explicit WorkStealingTaskProcessor(uint32_t numThreads = 0);
+        ~WorkStealingTaskProcessor() override;
+        void startTask(std::function<void()> f) override;
+        /**
+         * @brief Stop and join the worker threads. Tasks that haven't started are discarded.
+         */
+        void stop();
+        uint32_t getNumThreads() const
+        {
+            return static_cast<uint32_t>(_threads.size());
+        }
+    private:
+        class TaskDeque;
+        void run(size_t index);
+        bool tryRunTask(size_t index);
+        std::vector<std::unique_ptr<TaskDeque>> _deques;
+        std::vector<std::thread> _threads;
+        std::atomic<size_t> _nextDeque{0};
+        std::atomic<size_t> _pending{0};
+        std::atomic<size_t> _sleepers{0};
+        std::atomic<bool> _stop{false};
+        std::mutex _sleepMutex;
+        std::condition_variable _sleepCond;
+    };
+}
@@ -2,6 +2,7 @@
 
 #include "CsOverlay.h"
 #include "jsonUtils.h"
+#include "OverlayTextureTable.h"
 #include "pbr.h"
 #include "RuntimeEnvironment.h"
 #include "Styling.h"
@@ -12,6 +13,7 @@
 #include <rapidjson/document.h>
 
 #include <CesiumUtility/JsonHelpers.h>
+#include <optional>
 #include <stdexcept>
 #include <algorithm>
 
@@ -30,6 +32,74 @@ namespace
     {
         return ref_ptr_cast<TilesetNode>(factory->build(tsObject));
     }
+
+    // "adaptiveConcurrency" : true or { "minimum" : n, "maximum" : n, ... }
+    std::optional<AdaptiveConcurrencyOptions> readAdaptiveConcurrency(const rapidjson::Value& json)
+    {
+        const auto itr = json.FindMember("adaptiveConcurrency");
+        if (itr == json.MemberEnd())
+        {
+            return {};
+        }
+        AdaptiveConcurrencyOptions result;
+        if (itr->value.IsBool())
+        {
+            return itr->value.GetBool() ? std::optional(result) : std::nullopt;
+        }
+        if (!itr->value.IsObject())
+        {
+            vsg::warn("adaptiveConcurrency should be a boolean or an object");
+            return {};
+        }
+        const auto& valueJson = itr->value;
+        using CesiumUtility::JsonHelpers;
+        result.minimum = static_cast<int32_t>(JsonHelpers::getInt64OrDefault(valueJson, "minimum",
+                                                                             result.minimum));
+        result.maximum = static_cast<int32_t>(JsonHelpers::getInt64OrDefault(valueJson, "maximum",
+                                                                             result.maximum));
+        result.initial = static_cast<int32_t>(JsonHelpers::getInt64OrDefault(valueJson, "initial",
+                                                                             result.initial));
+        result.interval = std::chrono::duration<double>(
+            JsonHelpers::getDoubleOrDefault(valueJson, "interval", result.interval.count()));
+        result.latencyTolerance = JsonHelpers::getDoubleOrDefault(valueJson, "latencyTolerance",
+                                                                  result.latencyTolerance);
+        result.increase = static_cast<int32_t>(JsonHelpers::getInt64OrDefault(valueJson, "increase",
+                                                                              result.increase));
+        result.decrease = JsonHelpers::getDoubleOrDefault(valueJson, "decrease", result.decrease);
+        return result;
+    }
+
+    // "network" : { "defaultHostConcurrency" : n, "hostConcurrency" : { "host" : n, ...},
+    //               "adaptiveConcurrency" : ... }
+    // This is read before any tileset is built, as the tilesets' externals depend on it.
+    void initNetwork(const rapidjson::Value& networkJson)
+    {
+        auto env = RuntimeEnvironment::get();
+        if (auto adaptiveConcurrency = readAdaptiveConcurrency(networkJson))
+        {
+            env->setAdaptiveConcurrency(*adaptiveConcurrency);
+        }
+        auto defaultItr = networkJson.FindMember("defaultHostConcurrency");
+        if (defaultItr != networkJson.MemberEnd() && defaultItr->value.IsInt())
+        {
+            env->setDefaultHostConcurrencyLimit(defaultItr->value.GetInt());
+        }
+        auto hostsItr = networkJson.FindMember("hostConcurrency");
+        if (hostsItr != networkJson.MemberEnd() && hostsItr->value.IsObject())
+        {
+            for (const auto& member : hostsItr->value.GetObject())
+            {
+                if (member.value.IsInt())
+                {
+                    env->setHostConcurrencyLimit(member.name.GetString(), member.value.GetInt());
+                }
+                else
+                {
+                    vsg::warn("hostConcurrency value for ", member.name.GetString(), " is not an integer");
+                }
+            }
+        }
+    }
 }
 
 void WorldNode::init(const rapidjson::Value& worldJson, JSONObjectFactory* factory)
@@ -39,6 +109,11 @@ void WorldNode::init(const rapidjson::Value& worldJson, JSONObjectFactory* facto
         factory = JSONObjectFactory::get();
     }
     auto tilesetParent = ref_ptr_cast<vsg::StateGroup>(children[0]);
+    auto networkItr = worldJson.FindMember("network");
+    if (networkItr != worldJson.MemberEnd() && networkItr->value.IsObject())
+    {
+        initNetwork(networkItr->value);
+    }
     auto tilesetsItr = worldJson.FindMember("tilesets");
     if (tilesetsItr == worldJson.MemberEnd() || !tilesetsItr->value.IsArray())
     {
@@ -78,6 +153,12 @@ bool WorldNode::initialize(const vsg::ref_ptr<vsg::Viewer>& viewer)
                                               pbr::VIEW_DESCRIPTOR_SET);
     stateGroup->add(bindViewDescriptorSets);
     auto genv = RuntimeEnvironment::get()->genv;
+    if (genv->overlayTable)
+    {
+        // The table's descriptor set includes the blue noise texture.
+        genv->overlayTable->attach(stateGroup);
+        return result;
+    }
     auto descriptorBuilder
         = vsg::DescriptorConfigurator::create(genv->shaderFactory->getShaderSet(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST));
     vsg::ImageInfoList blueImage{genv->blueNoiseTexture};
@@ -92,6 +173,8 @@ bool WorldNode::initialize(const vsg::ref_ptr<vsg::Viewer>& viewer)
 
 void WorldNode::shutdown()
 {
+    // The tilesets' destruction waits for their requests to finish.
+    RuntimeEnvironment::get()->cancelNetworkRequests();
     for (const auto& node : tilesetNodes())
     {
         auto tilesetNode = ref_ptr_cast<TilesetNode>(node);
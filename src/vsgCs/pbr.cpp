@@ -30,43 +30,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/utils/ShaderSet.h>
 #include <vulkan/vulkan_core.h>
 
+#include <algorithm>
+
 namespace vsgCs::pbr
 {
-    vsg::ref_ptr<vsg::Data> makeTileData(float geometricError, float maxPointSize,
-                                         const std::span<OverlayParams> overlayUniformMem,
-                                         float fadeValue, bool fadeOut)
-    {
-        // All this hair with memcpy is to avoid using reinterpret_cast with a struct, apparently
-        // undefined behavior in C++.
-        vsg::vec4 tileScratch;
-        tileScratch[0] = geometricError;
-        tileScratch[1] = maxPointSize;
-        tileScratch[2] = fadeValue;
-        tileScratch[3] = fadeOut ? 1.0f : 0.0f;
-        auto result = vsg::ubyteArray::create(sizeof(vsg::vec4) + overlayUniformMem.size_bytes());
-        memcpy(&(*result)[0], &tileScratch, sizeof(tileScratch)); // NOLINT
-        memcpy(&(*result)[sizeof(tileScratch)], overlayUniformMem.data(), overlayUniformMem.size_bytes());
-        return result;
-    }
-
-    std::pair<float, bool> getFadeValue(const vsg::ref_ptr<vsg::Data>& tileData)
-    {
-        auto tileBufData = ref_ptr_cast<vsg::ubyteArray>(tileData);
-        float fadeValue;
-        memcpy(&fadeValue, tileBufData->data() + sizeof(float) * 2, sizeof(float));
-        float fadeOut;
-        memcpy(&fadeOut, tileBufData->data() + sizeof(float) * 3, sizeof(float));
-        return std::make_pair(fadeValue, fadeOut != 0.0f);
-    }
-
-    void setFadeValue(const vsg::ref_ptr<vsg::Data>& tileData, float fadeValue, bool fadeOut)
-    {
-        auto tileBufData = ref_ptr_cast<vsg::ubyteArray>(tileData);
-        float floatFadeOut = fadeOut ? 1.0f : 0.0f;
-        memcpy(tileBufData->data() + sizeof(float) * 2, &fadeValue, sizeof(float));
-        memcpy(tileBufData->data() + sizeof(float) * 3, &floatFadeOut, sizeof(float));
-    }
-
     void addBindings(const vsg::ref_ptr<vsg::ShaderSet>& shaderSet)
     {
         shaderSet->addAttributeBinding("vsg_Vertex", "", 0, VK_FORMAT_R32G32B32_SFLOAT, vsg::vec3Array::create(1));
@@ -121,11 +88,14 @@ namespace vsgCs::pbr
         shaderSet->addDescriptorBinding("blueNoise", "", WORLD_DESCRIPTOR_SET, 0,
                                         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1,
                                         VK_SHADER_STAGE_FRAGMENT_BIT, {});
+        // The parameters of all tiles are in shared buffers; see TileParameterBuffer.
         shaderSet->addDescriptorBinding("tileParams", "", TILE_DESCRIPTOR_SET, 0,
-                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, {});
+                                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, {});
         shaderSet->addDescriptorBinding("overlayTextures", "", TILE_DESCRIPTOR_SET, 1,
                                         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxOverlays, VK_SHADER_STAGE_FRAGMENT_BIT, {});
-
+        shaderSet->addDescriptorBinding("overlayTable", "VSGCS_OVERLAY_TABLE", WORLD_DESCRIPTOR_SET, 1,
+                                        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, overlayTableSize,
+                                        VK_SHADER_STAGE_FRAGMENT_BIT, {});
     }
     
     vsg::ref_ptr<vsg::ShaderSet> makeShaderSet(const vsg::ref_ptr<const vsg::Options>& options)
@@ -148,7 +118,8 @@ namespace vsgCs::pbr
 
         addBindings(shaderSet);
         addTileBindings(shaderSet);
-        shaderSet->optionalDefines.insert({"VSGCS_FLAT_SHADING", "VSGCS_BILLBOARD_NORMAL", "VSGCS_TILE"});
+        shaderSet->optionalDefines.insert({"VSGCS_FLAT_SHADING", "VSGCS_BILLBOARD_NORMAL", "VSGCS_TILE",
+                                           "VSGCS_OVERLAY_TABLE"});
         return shaderSet;
     }
 
@@ -191,7 +162,8 @@ namespace vsgCs::pbr
 
         addBindings(shaderSet);
         addTileBindings(shaderSet);
-        shaderSet->optionalDefines.insert({"VSGCS_BILLBOARD_NORMAL", "VSGCS_SIZE_TO_ERROR", "VSGCS_TILE"});
+        shaderSet->optionalDefines.insert({"VSGCS_BILLBOARD_NORMAL", "VSGCS_SIZE_TO_ERROR", "VSGCS_TILE",
+                                           "VSGCS_OVERLAY_TABLE"});
         return shaderSet;
     }
 }
@@ -26,28 +26,34 @@ namespace vsgCs
         struct OverlayParams
         {
             OverlayParams()
-                : alpha(1.0f), enabled(0), coordIndex(0)
+                : alpha(1.0f), enabled(0), coordIndex(0), textureIndex(0)
             {
-                pad[0] = 0;
             }
             vsg::vec2 translation;
             vsg::vec2 scale;
             float alpha;
             uint32_t enabled;
             uint32_t coordIndex;
-            uint32_t pad[1];
+            // Index of the overlay image in the overlay texture table; see OverlayTextureTable.
+            uint32_t textureIndex;
         };
 
         // This will eventually not be constant, but it will be a major event to change it at
         // runtime.
         const unsigned maxOverlays = 4;
+        // Number of images in the overlay texture table. Must match overlayTableSize in
+        // descriptor_defs.glsl.
+        const unsigned overlayTableSize = 1024;
 
-        vsg::ref_ptr<vsg::Data> makeTileData(float geometricError, float maxPointSize,
-                                             const std::span<OverlayParams> overlayUniformMem,
-                                             float fadeValue = 1.0f, bool fadeOut = false);
-        // Flesh out this API  a bit?
-        std::pair<float, bool> getFadeValue(const vsg::ref_ptr<vsg::Data>& tileData);
-        void setFadeValue(const vsg::ref_ptr<vsg::Data>& tileData, float fadeValue, bool fadeOut);
+        // The tile uniform structure, TileParams in the shaders.
+        struct TileParams
+        {
+            float geometricError = 0.0f;
+            float maxPointSize = 1.0f;
+            float fadeValue = 1.0f;
+            float fadeOut = 0.0f;       // using a float as a bool
+            OverlayParams overlayParams[maxOverlays];
+        };
         vsg::ref_ptr<vsg::ShaderSet> makeShaderSet(const vsg::ref_ptr<const vsg::Options>& options = {});
         vsg::ref_ptr<vsg::ShaderSet> makePointShaderSet(const vsg::ref_ptr<const vsg::Options>& options = {});
         vsg::ref_ptr<vsg::ShaderSet> makeModelShaderSet(const vsg::ref_ptr<const vsg::Options>& options = {});
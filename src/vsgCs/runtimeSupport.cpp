@@ -28,6 +28,7 @@ SOFTWARE.
 #include "Tracing.h"
 #include "runtimeSupport.h"
 #include "RuntimeEnvironment.h"
+#include "TaskStatistics.h"
 
 #include <Cesium3DTilesContent/registerAllTileContentTypes.h>
 #include <Cesium3DTilesSelection/BoundingVolume.h>
@@ -40,6 +41,7 @@ SOFTWARE.
 
 #include <cstdint>
 #include <cstdlib>
+#include <iostream>
 #include <type_traits>
 #include <vsg/core/Data.h>
 #include <vsg/maths/vec2.h>
@@ -59,6 +61,10 @@ namespace vsgCs
     void shutdown()
     {
         getAsyncSystemWrapper().shutdown();
+        if (RuntimeEnvironment::get()->printTaskStatistics)
+        {
+            std::cout << getTaskStatistics().toString();
+        }
     }
 
     vsg::ref_ptr<vsg::LookAt> makeLookAtFromTile(const Cesium3DTilesSelection::Tile* tile,
@@ -25,8 +25,12 @@ SOFTWARE.
 #include "vsgResourcePreparer.h"
 
 #include "CompilableImage.h"
+#include "OpThreadTaskProcessor.h"
+#include "OverlayTextureTable.h"
 #include "RuntimeEnvironment.h"
 #include "Styling.h"
+#include "TaskStatistics.h"
+#include "TileParameterBuffer.h"
 #include "Tracing.h"
 
 #include <CesiumGltfContent/GltfUtilities.h>
@@ -35,63 +39,146 @@ SOFTWARE.
 
 #include <gsl/util>
 
-#include <limits>
+#include <algorithm>
+#include <memory>
 
 using namespace vsgCs;
 using namespace CesiumGltf;
 
-// This deletion queue is a hack to not delete VSG objects (like buffers) while
-// they might still be in use. The problem is that VSG recycles descriptors...
+namespace
+{
+    // At the start of a frame, before it is recorded, every submission of the previous frames that
+    // hasn't finished holds one of these fences.
+    std::vector<vsg::ref_ptr<vsg::Fence>> pendingFences(vsg::Viewer& viewer)
+    {
+        // Enough for any swapchain
+        const size_t maxFences = 8;
+        std::vector<vsg::ref_ptr<vsg::Fence>> result;
+        for (auto& task : viewer.recordAndSubmitTasks)
+        {
+            for (size_t i = 0; i < maxFences; ++i)
+            {
+                auto fence = task->fence(i);
+                if (!fence)
+                {
+                    break;
+                }
+                if (fence->hasDependencies())
+                {
+                    result.push_back(fence);
+                }
+            }
+        }
+        return result;
+    }
+
+    // A fence with no dependencies has been waited for and reset, or was never submitted. A fence
+    // that is resubmitted after it was collected only delays the completion, which is still safe.
+    bool fencesSignaled(const std::vector<vsg::ref_ptr<vsg::Fence>>& fences)
+    {
+        return std::all_of(fences.begin(), fences.end(),
+                           [](const vsg::ref_ptr<vsg::Fence>& fence)
+                           {
+                               return !fence->hasDependencies() || fence->status() == VK_SUCCESS;
+                           });
+    }
+}
 
 DeletionQueue::DeletionQueue()
-    : lastFrameRun(std::numeric_limits<uint64_t>::max()), frameDelay(3)
+    : _frames(8)
 {
 }
 
+void DeletionQueue::pushFrame(uint64_t frameCount)
+{
+    if (_size == _frames.size())
+    {
+        // Grow the ring, keeping the oldest frame first.
+        std::vector<Frame> frames(_frames.size() * 2);
+        for (size_t i = 0; i < _size; ++i)
+        {
+            frames[i] = std::move(_frames[(_first + i) % _frames.size()]);
+        }
+        _frames = std::move(frames);
+        _first = 0;
+    }
+    ++_size;
+    Frame& frame = back();
+    frame.frameCount = frameCount;
+    frame.objects.clear();
+}
+
 void DeletionQueue::add(const vsg::ref_ptr<vsg::Viewer>& viewer,
                         const vsg::ref_ptr<vsg::Object>& object)
 {
-    queue.push_back(Deletion{viewer->getFrameStamp()->frameCount, object});
+    auto frameCount = viewer->getFrameStamp()->frameCount;
+    if (_size == 0 || back().frameCount != frameCount)
+    {
+        pushFrame(frameCount);
+    }
+    back().objects.push_back(object);
 }
 
 void DeletionQueue::run()
 {
-    queue.clear();
-    lastFrameRun = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < _size; ++i)
+    {
+        _frames[(_first + i) % _frames.size()].objects.clear();
+    }
+    _first = 0;
+    _size = 0;
+    _frameFences.clear();
 }
 
-int runningDeletion = 0;
-
 void DeletionQueue::run(const vsg::ref_ptr<vsg::Viewer>& viewer)
 {
     VSGCS_ZONESCOPED;
-    runningDeletion = 1;
-    const auto* frameStamp = viewer->getFrameStamp();
-    if (lastFrameRun == std::numeric_limits<uint64_t>::max())
+    auto frameCount = viewer->getFrameStamp()->frameCount;
+    if (_frameFences.empty() || _frameFences.back().frameCount < frameCount)
     {
-        queue.clear();
+        _frameFences.push_back(FrameFences{frameCount, pendingFences(*viewer)});
     }
-    else
+    while (!_frameFences.empty() && fencesSignaled(_frameFences.front().fences))
     {
-        if (frameStamp->frameCount <= lastFrameRun)
+        // The frames before this one are finished.
+        if (_frameFences.front().frameCount > 0)
         {
-            return;
-        }
-        auto itr = queue.begin();
-        while (itr != queue.end())
-        {
-            if (itr->frameRemoved + frameDelay <= frameStamp->frameCount)
-            {
-                itr = queue.erase(itr);
-            }
-            else
-            {
-                break;
-            }
+            _completedFrame = _frameFences.front().frameCount - 1;
         }
+        _frameFences.pop_front();
+    }
+    while (_size > 0 && _completedFrame && _frames[_first].frameCount <= *_completedFrame)
+    {
+        _frames[_first].objects.clear();
+        _first = (_first + 1) % _frames.size();
+        --_size;
+    }
+    VSGCS_PLOT("objects awaiting deletion", static_cast<int64_t>(size()));
+}
+
+FrameProgress DeletionQueue::getProgress(const vsg::ref_ptr<vsg::Viewer>& viewer) const
+{
+    return FrameProgress{viewer->getFrameStamp()->frameCount, _completedFrame};
+}
+
+size_t DeletionQueue::size() const
+{
+    size_t result = 0;
+    for (size_t i = 0; i < _size; ++i)
+    {
+        result += _frames[(_first + i) % _frames.size()].objects.size();
+    }
+    return result;
+}
+
+void UpdateResourcePreparer::run()
+{
+    auto ref_preparer = preparer.lock();
+    vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer;
+    if (ref_preparer && ref_viewer)
+    {
+        ref_preparer->updateFrame(ref_viewer);
     }
-    lastFrameRun = frameStamp->frameCount;
-    runningDeletion = 0;
 }
 
 vsgResourcePreparer::vsgResourcePreparer(const vsg::ref_ptr<GraphicsEnvironment>& genv,
@@ -101,20 +188,19 @@ vsgResourcePreparer::vsgResourcePreparer(const vsg::ref_ptr<GraphicsEnvironment>
 }
 
 LoadModelResult*
-vsgResourcePreparer::readAndCompile(Cesium3DTilesSelection::TileLoadResult &&tileLoadResult,
-                                    const glm::dmat4& transform,
-                                    const CreateModelOptions& options)
+vsgResourcePreparer::readModel(Cesium3DTilesSelection::TileLoadResult &&tileLoadResult,
+                               const glm::dmat4& transform,
+                               const CreateModelOptions& options)
 {
     vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer;
     if (!ref_viewer)
     {
         return nullptr;
     }
+    TaskTimer timer(TaskCategory::Build);
     auto resultNode = _builder->loadTile(std::move(tileLoadResult), transform, options);
     auto* result = new LoadModelResult;
     result->modelResult = resultNode;
-    VSGCS_ZONESCOPEDN("model compile");
-    result->compileResult = ref_viewer->compileManager->compile(resultNode);
     return result;
 }
 
@@ -124,11 +210,14 @@ RenderResources* merge(vsgResourcePreparer* preparer, LoadModelResult& result,
     vsg::ref_ptr<vsg::Viewer> ref_viewer = preparer->viewer;
     if (ref_viewer)
     {
-        updateViewer(*ref_viewer, result.compileResult);
-        auto attachCompileResult = preparer->genv->miniCompile(attachResult.descriptorData);
-        vsg::updateViewer(*ref_viewer, attachCompileResult);
-        return new RenderResources{attachResult.updatedModel};
+        if (result.compileResult)
+        {
+            UploadBatcher::apply(*ref_viewer, *result.compileResult);
+        }
+        preparer->queueMiniCompile(attachResult.descriptorData);
+        return new RenderResources{attachResult.updatedModel, attachResult.parameterSlot};
     }
+    preparer->genv->tileParameters->free(attachResult.parameterSlot);
     return nullptr;
 }
 
@@ -156,11 +245,29 @@ vsgResourcePreparer::prepareInLoadThread(const CesiumAsync::AsyncSystem& asyncSy
     {
         options.styling = std::any_cast<vsg::ref_ptr<Styling>>(rendererOptions);
     }
-    LoadModelResult* result = readAndCompile(std::move(tileLoadResult), transform, options);
-    return asyncSystem.createResolvedFuture(
-        Cesium3DTilesSelection::TileLoadResultAndRenderResources{
-            std::move(tileLoadResult),
-            result});
+    // Owned by the continuation until it's handed to Cesium, so that it is freed if the compile
+    // fails.
+    std::unique_ptr<LoadModelResult> result(readModel(std::move(tileLoadResult), transform, options));
+    if (!result)
+    {
+        return asyncSystem.createResolvedFuture(
+            Cesium3DTilesSelection::TileLoadResultAndRenderResources{
+                std::move(tileLoadResult),
+                nullptr});
+    }
+    vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer;
+    // Building the model is CPU work on this worker thread; the upload to the GPU is done in a
+    // batch with other tiles, in the upload pool, so that it doesn't hold up decoding.
+    auto modelResult = result->modelResult;
+    return _uploadBatcher.compile(ref_viewer, modelResult)
+        .thenImmediately([result = std::move(result), tileLoadResult = std::move(tileLoadResult)]
+                         (std::shared_ptr<UploadBatch>&& batch) mutable
+        {
+            result->compileResult = std::move(batch);
+            return Cesium3DTilesSelection::TileLoadResultAndRenderResources{
+                std::move(tileLoadResult),
+                result.release()};
+        });
 }
 
 void*
@@ -194,7 +301,6 @@ void vsgResourcePreparer::free(Cesium3DTilesSelection::Tile&,
 
     if (ref_viewer)
     {
-        _deletionQueue.run(ref_viewer);
         if (pLoadThreadResult)
         {
             _deletionQueue.add(ref_viewer, loadModelResult->modelResult);
@@ -205,6 +311,10 @@ void vsgResourcePreparer::free(Cesium3DTilesSelection::Tile&,
         }
 
     }
+    if (renderResources)
+    {
+        genv->tileParameters->free(renderResources->parameterSlot);
+    }
     delete loadModelResult;
     delete renderResources;
 }
@@ -219,6 +329,7 @@ vsgResourcePreparer::prepareRasterInLoadThread(CesiumGltf::ImageAsset& image,
     {
         return nullptr;
     }
+    TaskTimer timer(TaskCategory::Raster);
     auto result = _builder->loadTexture(image,
                                         VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
                                         VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
@@ -228,8 +339,10 @@ vsgResourcePreparer::prepareRasterInLoadThread(CesiumGltf::ImageAsset& image,
                                         true);
     auto compilable = CompilableImage::create(result);
     {
+        // Cesium wants the result now, so don't wait for the batch window.
         VSGCS_ZONESCOPEDN("compile raster");
-        return new LoadRasterResult{compilable->imageInfo, ref_viewer->compileManager->compile(compilable),
+        return new LoadRasterResult{compilable->imageInfo,
+                                    _uploadBatcher.compileNow(ref_viewer, compilable),
                                     std::any_cast<OverlayRendererOptions>(rendererOptions)};
     }
 }
@@ -244,16 +357,23 @@ vsgResourcePreparer::prepareRasterInMainThread(CesiumRasterOverlays::RasterOverl
         return nullptr;
     }
     auto* loadRasterResult = static_cast<LoadRasterResult*>(rawLoadResult);
-    if (vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer)
+    vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer;
+    if (ref_viewer && loadRasterResult->compileResult)
     {
-        vsg::updateViewer(*ref_viewer, loadRasterResult->compileResult);
+        UploadBatcher::apply(*ref_viewer, *loadRasterResult->compileResult);
     }
     auto deleter = gsl::finally([loadRasterResult]()
     {
         delete loadRasterResult;
     });
+    uint32_t tableIndex = 0;
+    if (genv->overlayTable && loadRasterResult->rasterResult)
+    {
+        tableIndex = genv->overlayTable->add(loadRasterResult->rasterResult);
+    }
     return  new RasterResources{.raster = loadRasterResult->rasterResult,
-                                .overlayOptions = loadRasterResult->overlayOptions};
+                                .overlayOptions = loadRasterResult->overlayOptions,
+                                .tableIndex = tableIndex};
 }
 
 void
@@ -267,7 +387,6 @@ vsgResourcePreparer::freeRaster(const CesiumRasterOverlays::RasterOverlayTile&,
     auto* rasterResources = static_cast<RasterResources*>(mainThreadResult);
     if (ref_viewer)
     {
-        _deletionQueue.run(ref_viewer);
         if (loadThreadResult)
         {
             _deletionQueue.add(ref_viewer, loadRasterResult->rasterResult);
@@ -277,27 +396,70 @@ vsgResourcePreparer::freeRaster(const CesiumRasterOverlays::RasterOverlayTile&,
             _deletionQueue.add(ref_viewer, rasterResources->raster);
         }
     }
+    if (rasterResources && genv->overlayTable)
+    {
+        genv->overlayTable->remove(rasterResources->tableIndex);
+    }
 
     delete loadRasterResult;
     delete rasterResources;
 }
 
-void vsgResourcePreparer::compileAndDelete(ModifyRastersResult& result)
+void vsgResourcePreparer::queueMiniCompile(const vsg::ref_ptr<vsg::Object>& object)
+{
+    _miniCompileBatch.compileObjects.push_back(object);
+}
+
+void vsgResourcePreparer::compilePending()
 {
     vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer;
-    if (!ref_viewer)
+    if (!ref_viewer || _miniCompileBatch.empty())
     {
         return;
     }
-    for (const auto& object : result.compileObjects)
+    auto progress = _deletionQueue.getProgress(ref_viewer);
+    auto compileResult = genv->miniCompile(_miniCompileBatch, progress);
+    _miniCompileBatch = {};
+    _compileResults.push_back(FrameCompileResult{progress.frameCount, compileResult});
+}
+
+void vsgResourcePreparer::updateFrame(const vsg::ref_ptr<vsg::Viewer>& viewer)
+{
+    VSGCS_ZONESCOPED;
+    _deletionQueue.run(viewer);
+    // Anything queued outside of a tileset update
+    compilePending();
+    auto frameCount = viewer->getFrameStamp()->frameCount;
+    vsg::CompileResult compileResult;
+    auto itr = std::partition(_compileResults.begin(), _compileResults.end(),
+                              [frameCount](const FrameCompileResult& result)
+                              {
+                                  return result.frameCount >= frameCount;
+                              });
+    if (itr != _compileResults.end())
     {
+        for (auto resultItr = itr; resultItr != _compileResults.end(); ++resultItr)
+        {
+            compileResult.add(resultItr->compileResult);
+        }
+        _compileResults.erase(itr, _compileResults.end());
+        vsg::updateViewer(*viewer, compileResult);
+    }
+}
 
-        auto attachCompileResult = genv->miniCompile(object);
-        vsg::updateViewer(*ref_viewer, attachCompileResult);
+void vsgResourcePreparer::compileAndDelete(ModifyRastersResult& result)
+{
+    vsg::ref_ptr<vsg::Viewer> ref_viewer = viewer;
+    if (!ref_viewer)
+    {
+        return;
     }
+    _miniCompileBatch.compileObjects.insert(_miniCompileBatch.compileObjects.end(),
+                                            result.compileObjects.begin(), result.compileObjects.end());
+    _miniCompileBatch.rewriteObjects.insert(_miniCompileBatch.rewriteObjects.end(),
+                                            result.rewriteObjects.begin(), result.rewriteObjects.end());
     if (!result.deleteObjects.empty())
     {
-        _deletionQueue.run(ref_viewer);
         _deletionQueue.addObjects(ref_viewer, result.deleteObjects);
     }
 }
@@ -324,7 +486,8 @@ vsgResourcePreparer::attachRasterInMainThread(const Cesium3DTilesSelection::Tile
 
         auto results = _builder->attachRaster(tile, resources->model,
                                              overlayTextureCoordinateID, rasterTile,
-                                             pMainThreadRendererResources, translation, scale);
+                                             pMainThreadRendererResources, translation, scale,
+                                             _deletionQueue.getProgress(ref_viewer));
         compileAndDelete(results);
     }
 }
@@ -347,7 +510,8 @@ vsgResourcePreparer::detachRasterInMainThread(const Cesium3DTilesSelection::Tile
     if (renderContent)
     {
         auto* resources = static_cast<RenderResources*>(renderContent->getRenderResources());
-        auto results = _builder->detachRaster(tile, resources->model, overlayTextureCoordinateID, rasterTile);
+        auto results = _builder->detachRaster(tile, resources->model, overlayTextureCoordinateID, rasterTile,
+                                              _deletionQueue.getProgress(ref_viewer));
         compileAndDelete(results);
     }
 }
@@ -32,22 +32,23 @@ SOFTWARE.
 #include "GraphicsEnvironment.h"
 #include "LoadGltfResult.h"
 #include "CesiumGltfBuilder.h"
+#include "UploadBatcher.h"
 
 #include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace vsgCs
 {
-    // Sort of a hack to delay deletion of vsg::Objects for 2 frames, in order to not delete Vulkan
-    // objects that are still referenced by active command buffers.
+    // Delays the deletion of vsg::Objects until the GPU is done with the command buffers that might
+    // reference them. Objects retired in a frame go in that frame's bucket in a ring. At the start
+    // of every frame, the fences of all the viewer's submissions in flight are recorded; once they
+    // have signaled, every frame before that one is complete and its bucket is released.
     class DeletionQueue
     {
     public:
         DeletionQueue();
-        struct Deletion
-        {
-            uint64_t frameRemoved;
-            vsg::ref_ptr<vsg::Object> object;
-        };
         void add(const vsg::ref_ptr<vsg::Viewer>& viewer, const vsg::ref_ptr<vsg::Object>& object);
         // Add A "list" of objects for deletion
         template<typename TSpan>
@@ -58,15 +59,38 @@ namespace vsgCs
                 add(viewer, object);
             }
         }
-        // Remove everything from queue.
+        // Remove everything from queue. Only safe when the device is idle.
         void run();
-        // Run at this frame
+        // Release the objects whose frames have finished on the GPU. Called every frame by an
+        // UpdateResourcePreparer update operation.
         void run(const vsg::ref_ptr<vsg::Viewer>& viewer);
-        uint64_t lastFrameRun;
-        std::deque<Deletion> queue;
-        // A safe value for this seems to depend on the swapchain minImageCount in obscure
-        // ways. Hardwired to 3 for now.
-        uint64_t frameDelay;
+        // Number of objects waiting for deletion
+        size_t size() const;
+        // The current frame and the last frame known to be finished on the GPU
+        FrameProgress getProgress(const vsg::ref_ptr<vsg::Viewer>& viewer) const;
+    private:
+        struct Frame
+        {
+            uint64_t frameCount = 0;
+            std::vector<vsg::ref_ptr<vsg::Object>> objects;
+        };
+        // Submissions in flight at the start of a frame
+        struct FrameFences
+        {
+            uint64_t frameCount = 0;
+            std::vector<vsg::ref_ptr<vsg::Fence>> fences;
+        };
+        Frame& back()
+        {
+            return _frames[(_first + _size - 1) % _frames.size()];
+        }
+        void pushFrame(uint64_t frameCount);
+        // Ring of buckets, oldest first
+        std::vector<Frame> _frames;
+        size_t _first = 0;
+        size_t _size = 0;
+        std::deque<FrameFences> _frameFences;
+        std::optional<uint64_t> _completedFrame;
     };
 
     struct DeviceFeatures;
@@ -112,12 +136,55 @@ namespace vsgCs
                                       void* pMainThreadRendererResources) noexcept override;
         vsg::observer_ptr<vsg::Viewer> viewer;
         vsg::ref_ptr<GraphicsEnvironment> genv;
+        UploadBatcher& getUploadBatcher()
+        {
+            return _uploadBatcher;
+        }
+        DeletionQueue& getDeletionQueue()
+        {
+            return _deletionQueue;
+        }
+        // Compile an object, with others, in compilePending().
+        void queueMiniCompile(const vsg::ref_ptr<vsg::Object>& object);
+        /**
+         * @brief Compile the objects and rewrite the descriptor sets queued since the last call,
+         * in one batch. Must be called after the tiles are updated and before the frame is
+         * recorded.
+         */
+        void compilePending();
+        /**
+         * @brief Per-frame work: release the resources that the GPU is done with, compile any
+         * pending objects, and update the viewer with the compile results of earlier frames.
+         */
+        void updateFrame(const vsg::ref_ptr<vsg::Viewer>& viewer);
     protected:
-        LoadModelResult* readAndCompile(Cesium3DTilesSelection::TileLoadResult &&tileLoadResult,
-                                        const glm::dmat4& transform,
-                                        const CreateModelOptions& options);
+        LoadModelResult* readModel(Cesium3DTilesSelection::TileLoadResult &&tileLoadResult,
+                                   const glm::dmat4& transform,
+                                   const CreateModelOptions& options);
         void compileAndDelete(ModifyRastersResult& result);
         vsg::ref_ptr<CesiumGltfBuilder> _builder;
         DeletionQueue _deletionQueue;
+        UploadBatcher _uploadBatcher;
+        MiniCompileBatch _miniCompileBatch;
+        struct FrameCompileResult
+        {
+            uint64_t frameCount;
+            vsg::CompileResult compileResult;
+        };
+        std::vector<FrameCompileResult> _compileResults;
+    };
+
+    /**
+     * @brief Update operation that runs vsgResourcePreparer::updateFrame() every frame.
+     */
+    struct UpdateResourcePreparer : public vsg::Inherit<vsg::Operation, UpdateResourcePreparer>
+    {
+        UpdateResourcePreparer(const std::shared_ptr<vsgResourcePreparer>& in_preparer,
+                           const vsg::ref_ptr<vsg::Viewer>& in_viewer)
+            : preparer(in_preparer), viewer(in_viewer)
+        {}
+        void run() override;
+        std::weak_ptr<vsgResourcePreparer> preparer;
+        vsg::observer_ptr<vsg::Viewer> viewer;
     };
 }